@@ -2,12 +2,86 @@
 #pragma once
 
 #include "data_book.hpp"
+#include "scoring_policies.hpp"
 #include <cstdint>
+#include <string>
+#include <type_traits>
 
-class CompositeScoreCalculator {
+// Scoring engine with the algorithm fixed at compile time; Policy is one of
+// the types in scoring_policies.hpp and inlines completely
+template <typename Policy>
+class ScoringEngine {
 public:
-    CompositeScoreCalculator() = default;
+    using policy_type = Policy;
 
-    // Returns composite score * 1e9 (already scaled), using integer arithmetic
-    int64_t calculateCompositeScore(const DataBook& book);
+    // Returns composite score * 1e9 (already scaled)
+    int64_t calculateCompositeScore(const DataBook& book) const { return Policy::score(book); }
+
+    // Book levels the score reads. An update whose DirtyLevels misses these
+    // leaves the score unchanged.
+    static constexpr DirtyLevels dependencies() { return Policy::dependencies(); }
+
+    // True when ScoreBatch may score with its level-0 kernel instead
+    static constexpr bool isTopOfBookMidpoint() {
+        return std::is_same<Policy, scoring::TopOfBookMidpoint>::value;
+    }
+};
+
+// The service's default: level-0 volume-weighted midpoint, integer arithmetic
+using CompositeScoreCalculator = ScoringEngine<scoring::TopOfBookMidpoint>;
+
+// One entry per policy instantiation selectable by name at runtime
+struct ScorerInfo {
+    const char* name;
+    const char* description;
+    int64_t (*score)(const DataBook& book);   // ScoringEngine<Policy> body, inlined
+    int64_t (*score_snapshot)(const BookSnapshot& book);
+    DirtyLevels dependencies;
+    bool top_of_book_midpoint;                // ScoreBatch's level-0 kernel computes the same score
 };
+
+// Policy chosen from the registry: one indirect call per score, with the
+// policy inlined behind it. Defaults to "top".
+class RegisteredScorer {
+public:
+    RegisteredScorer();
+    explicit RegisteredScorer(const ScorerInfo& info) : info_(&info) {}
+
+    int64_t calculateCompositeScore(const DataBook& book) const { return info_->score(book); }
+    DirtyLevels dependencies() const { return info_->dependencies; }
+    bool isTopOfBookMidpoint() const { return info_->top_of_book_midpoint; }
+    const char* name() const { return info_->name; }
+
+private:
+    const ScorerInfo* info_;
+};
+
+// Several registered policies scored together: one consistent snapshot of the
+// book feeds every policy, and the results form one output record. The set's
+// dependencies are the union of its policies', so a message is skipped only
+// if it can move none of the outputs.
+class ScoreSet {
+public:
+    // false if the set already holds MAX_SCORE_OUTPUTS policies
+    bool add(const ScorerInfo& info);
+
+    size_t size() const { return count_; }
+    const ScorerInfo& scorer(size_t i) const { return *infos_[i]; }
+    DirtyLevels dependencies() const { return dependencies_; }
+
+    // Writes output i of the set to scores[i], for i < size()
+    void calculateScores(const DataBook& book, int64_t* scores) const {
+        const BookSnapshot snapshot = book.snapshot();
+        for (size_t i = 0; i < count_; ++i) scores[i] = infos_[i]->score_snapshot(snapshot);
+    }
+
+private:
+    const ScorerInfo* infos_[MAX_SCORE_OUTPUTS] = {};
+    size_t count_ = 0;
+    DirtyLevels dependencies_;
+};
+
+// Registered policies, terminated by an entry with name == nullptr
+const ScorerInfo* scorer_registry();
+// nullptr if no policy has that name
+const ScorerInfo* find_scorer(const std::string& name);
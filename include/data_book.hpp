@@ -2,36 +2,212 @@
 #pragma once
 
 #include "types.hpp"
+#include "score_analytics.hpp"
 #include <array>
-#include <unordered_map>
-#include <mutex>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
 
-class DataBook {
+// Consistent copy of level 0 of one book; values scaled by 1e9
+struct TopOfBook {
+    int64_t demand_value = 0;
+    int demand_volume = 0;
+    int64_t supply_value = 0;
+    int supply_volume = 0;
+};
+
+// Consistent copy of every level of one book; values scaled by 1e9
+struct BookSnapshot {
+    std::array<int64_t, MAX_BOOK_LEVELS> demand_values{};
+    std::array<int, MAX_BOOK_LEVELS> demand_volumes{};
+    std::array<int64_t, MAX_BOOK_LEVELS> supply_values{};
+    std::array<int, MAX_BOOK_LEVELS> supply_volumes{};
+};
+
+// Levels written by one batch of updates: bit i of the low half is demand
+// level i, bit i of the high half is supply level i
+struct DirtyLevels {
+    uint32_t bits = 0;
+
+    uint16_t demand() const { return static_cast<uint16_t>(bits); }
+    uint16_t supply() const { return static_cast<uint16_t>(bits >> 16); }
+    bool any() const { return bits != 0; }
+    bool touchesTop() const { return (bits & 0x00010001u) != 0; }
+    bool intersects(DirtyLevels other) const { return (bits & other.bits) != 0; }
+};
+
+// Single-writer seqlock: applyUpdate() must only ever be called from the one
+// thread that owns the book (the receive thread, or a shard's worker), while
+// any number of threads may read. Readers never block the writer; a
+// snapshot taken during an update is retried until it sees none.
+//
+// Values are kept as the wire's fixed-point integers (scaled by 1e9). The
+// first cache line holds the sequence counter and level 0 of both sides, so
+// applying a top-of-book update and scoring touch one line; deeper levels
+// follow two to a line.
+class alignas(64) DataBook {
 public:
-    DataBook();
+    DataBook() = default;
 
     void applyUpdate(const DataLevel& update);
-    double demandValue(int level) const;
+
+    // Applies every DataLevel of one message (ProcessedMessage::updates or an
+    // UpdateView) as a single seqlock write, so readers see all of it or none,
+    // and reports which levels it touched
+    template <typename Updates>
+    DirtyLevels applyUpdates(const Updates& updates);
+
+    TopOfBook topOfBook() const;
+    BookSnapshot snapshot() const;
+
+    // Single fields, each read on its own; use topOfBook()/snapshot() when
+    // several must agree
+    int64_t demandValueScaled(int level) const;
+    int64_t supplyValueScaled(int level) const;
     int demandVolume(int level) const;
-    double supplyValue(int level) const;
     int supplyVolume(int level) const;
+    double demandValue(int level) const { return static_cast<double>(demandValueScaled(level)) / 1e9; }
+    double supplyValue(int level) const { return static_cast<double>(supplyValueScaled(level)) / 1e9; }
     int numLevels() const { return MAX_BOOK_LEVELS; }
 
 private:
-    std::array<int64_t, MAX_BOOK_LEVELS> demand_values_;
-    std::array<int, MAX_BOOK_LEVELS> demand_volumes_;
-    std::array<int64_t, MAX_BOOK_LEVELS> supply_values_;
-    std::array<int, MAX_BOOK_LEVELS> supply_volumes_;
+    // Atomic only so concurrent reads are defined; every access is relaxed
+    // and compiles to a plain load or store
+    struct FixedLevel {
+        std::atomic<int64_t> value{0};
+        std::atomic<int32_t> volume{0};
+    };
+    struct alignas(32) LevelPair {
+        FixedLevel sides[2];   // [0] = demand, [1] = supply
+    };
+    static_assert(sizeof(LevelPair) == 32, "two levels per cache line");
+
+    template <typename Copy>
+    void readConsistent(Copy&& copy) const;
+
+    void beginWrite(uint32_t& seq);
+    void endWrite(uint32_t seq) { seq_.store(seq + 2, std::memory_order_release); }
+    FixedLevel& slot(const DataLevel& u) { return levels_[u.level].sides[u.side != 0]; }
 
-    mutable std::mutex mtx_;
+    // Odd while an update is being written
+    std::atomic<uint32_t> seq_{0};
+    // levels_[0] lands at offset 32, in the same line as seq_
+    std::array<LevelPair, MAX_BOOK_LEVELS> levels_;
 };
 
-// DataBookManager maintains one book per subject
+template <typename Copy>
+inline void DataBook::readConsistent(Copy&& copy) const {
+    uint32_t before;
+    uint32_t after = 0;
+    do {
+        before = seq_.load(std::memory_order_acquire);
+        if (before & 1) continue;   // writer mid-update
+        copy();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = seq_.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+}
+
+inline void DataBook::beginWrite(uint32_t& seq) {
+    // Only the owning thread writes seq_, so a plain increment is enough
+    seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+template <typename Updates>
+inline DirtyLevels DataBook::applyUpdates(const Updates& updates) {
+    DirtyLevels dirty;
+    uint32_t seq;
+    beginWrite(seq);
+    for (const DataLevel& u : updates) {
+        if (u.level >= MAX_BOOK_LEVELS) continue;
+        FixedLevel& lvl = slot(u);
+        lvl.value.store(u.value, std::memory_order_relaxed);
+        lvl.volume.store(static_cast<int32_t>(u.volume), std::memory_order_relaxed);
+        dirty.bits |= 1u << (u.level + (u.side != 0 ? 16 : 0));
+    }
+    endWrite(seq);
+    return dirty;
+}
+
+// Inline: the calculator reads the hot line directly on every message
+inline TopOfBook DataBook::topOfBook() const {
+    TopOfBook top;
+    readConsistent([&] {
+        const LevelPair& l0 = levels_[0];
+        top.demand_value = l0.sides[0].value.load(std::memory_order_relaxed);
+        top.demand_volume = l0.sides[0].volume.load(std::memory_order_relaxed);
+        top.supply_value = l0.sides[1].value.load(std::memory_order_relaxed);
+        top.supply_volume = l0.sides[1].volume.load(std::memory_order_relaxed);
+    });
+    return top;
+}
+
+struct EmissionPolicy;
+
+// Everything one message touches for its subject, kept together so a single
+// lookup reaches the book and the send state. Output i of a multi-score
+// record (ScoreSet) is element i of scores and last_sent_scores; a single
+// score is element 0. analytics follows the sent values of output 0.
+struct alignas(64) SubjectRecord {
+    DataBook book;
+    bool sent = false;            // a score has gone out for this subject
+    bool scored = false;          // scores hold the results for the current book inputs
+    int16_t batch_slot = -1;      // entry in a ScoreBatch while queued for scoring, else -1
+    std::array<int64_t, MAX_SCORE_OUTPUTS> last_sent_scores{};
+    std::array<int64_t, MAX_SCORE_OUTPUTS> scores{};
+    ScoreAnalytics analytics;     // updated per send when records carry analytics
+    // EmissionThrottle state: the subject's policy (resolved on its first
+    // throttled change), its last send time, and whether a change is held.
+    // Held subjects are chained in hold order through throttle_next; the
+    // chain fields fill the record's tail padding.
+    const EmissionPolicy* emission_policy = nullptr;
+    uint64_t last_send_ns = 0;
+    bool throttle_held = false;
+    uint8_t throttle_count = 0;          // outputs of the held change
+    uint32_t throttle_subject_id = 0;
+    SubjectRecord* throttle_next = nullptr;
+};
+
+// DataBookManager maintains one record per subject. It belongs to the one
+// thread that applies updates (the receive thread, or a shard's worker), so
+// lookups take no lock. Records never move once created.
+//
+// IDs are kept in an open-addressing flat hash. Constructed with a range, it
+// also keeps a directly indexed array for [first_id, first_id + count), so
+// dense IDs such as 10000-20000 cost one array access; IDs outside the range
+// still go to the hash.
 class DataBookManager {
 public:
-    DataBook& getOrCreateBook(uint32_t subject_id);
+    DataBookManager() = default;
+    DataBookManager(uint32_t first_id, uint32_t count);
+
+    SubjectRecord& getOrCreate(uint32_t subject_id) {
+        uint32_t idx = subject_id - first_id_;   // wraps below first_id_
+        if (idx < dense_count_) return dense_[idx];
+        return getOrCreateSparse(subject_id);
+    }
+    DataBook& getOrCreateBook(uint32_t subject_id) { return getOrCreate(subject_id).book; }
 
 private:
-    std::unordered_map<uint32_t, DataBook> books_;
-    std::mutex books_mtx_;
+    struct Slot {
+        uint32_t subject_id = 0;
+        SubjectRecord* record = nullptr;   // nullptr = empty
+    };
+
+    SubjectRecord& getOrCreateSparse(uint32_t subject_id);
+    size_t slotFor(uint32_t subject_id) const;
+    void growIndex();
+
+    uint32_t first_id_ = 0;
+    uint32_t dense_count_ = 0;
+    std::unique_ptr<SubjectRecord[]> dense_;
+
+    // Linear probing over a power-of-two index kept at most half full; growing
+    // rebuilds the index only, the records stay in sparse_
+    std::vector<Slot> slots_;
+    unsigned slot_shift_ = 32;
+    std::deque<SubjectRecord> sparse_;   // deque: appending never moves records
 };
@@ -0,0 +1,106 @@
+// emission_throttle.hpp
+#pragma once
+
+#include "data_book.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// When a subject's new scores are worth sending. Zero fields impose nothing,
+// so the default policy sends every change.
+struct EmissionPolicy {
+    int64_t min_abs_delta = 0;       // scaled score units
+    int64_t min_rel_delta_ppb = 0;   // relative to the last value sent, parts per billion
+    uint64_t min_interval_ns = 0;    // between two sends of one subject (1e9 / max rate)
+
+    bool limitsRate() const { return min_interval_ns > 0; }
+};
+
+// Parses "abs=N,rel=F,rate=HZ" (any subset, any order): abs in scaled units,
+// rel as a fraction of the last value sent, rate as sends per second.
+// False on anything else.
+bool parse_emission_policy(const std::string& spec, EmissionPolicy& out);
+
+struct EmissionThrottleStats {
+    uint64_t dropped = 0;    // changes below the delta threshold
+    uint64_t held = 0;       // changes deferred by the rate limit
+    uint64_t released = 0;   // deferred values sent once their interval ended
+};
+
+// Per-subject emission throttling for one processing thread. A change is
+// sent only if, for some output, it reaches the subject's delta thresholds
+// against the value last sent. A change that comes too soon after the last
+// send is held; releaseDue() later sends the subject's latest scores, if they
+// still qualify, so the final value is never lost. The first send of a
+// subject always goes out.
+//
+// Policies are the default plus subject ID ranges; a later range wins where
+// ranges overlap. Each subject resolves its policy once and keeps a pointer
+// to it in its SubjectRecord. Held subjects are chained through their
+// SubjectRecords, so holding a change never allocates.
+class EmissionThrottle {
+public:
+    enum class Decision { Send, Drop, Hold };
+
+    void setDefault(const EmissionPolicy& policy) { default_ = policy; }
+    // Before processing starts: subjects keep pointers to the policies
+    void addRange(uint32_t first_id, uint32_t last_id, const EmissionPolicy& policy);
+    // Shortest rate-limit interval of any policy, 0 if none limits the rate
+    uint64_t minIntervalNs() const;
+
+    // What to do with changed scores of a subject that has sent before; on
+    // Send the subject's send time is updated, on Hold it is queued for
+    // releaseDue()
+    Decision admit(uint32_t subject_id, SubjectRecord& subject, const int64_t* scores, size_t count, uint64_t now);
+
+    // Calls send(subject_id, subject, count) for every held subject whose
+    // interval has ended by now and whose latest scores still qualify.
+    // now = UINT64_MAX releases everything (shutdown).
+    template <typename Send>
+    void releaseDue(uint64_t now, Send&& send);
+
+    const EmissionThrottleStats& stats() const { return stats_; }
+
+private:
+    struct Range {
+        uint32_t first_id;
+        uint32_t last_id;
+        EmissionPolicy policy;
+    };
+    const EmissionPolicy& policyFor(SubjectRecord& subject, uint32_t subject_id) const;
+    static bool significant(const EmissionPolicy& policy, const SubjectRecord& subject, const int64_t* scores,
+                            size_t count);
+
+    EmissionPolicy default_;
+    std::vector<Range> ranges_;
+    SubjectRecord* held_head_ = nullptr;   // oldest hold first
+    SubjectRecord* held_tail_ = nullptr;
+    EmissionThrottleStats stats_;
+};
+
+template <typename Send>
+inline void EmissionThrottle::releaseDue(uint64_t now, Send&& send) {
+    SubjectRecord** link = &held_head_;
+    SubjectRecord* last_kept = nullptr;
+    while (SubjectRecord* held = *link) {
+        SubjectRecord& subject = *held;
+        const EmissionPolicy& policy = *subject.emission_policy;
+        if (now != UINT64_MAX && now - subject.last_send_ns < policy.min_interval_ns) {
+            last_kept = held;
+            link = &subject.throttle_next;
+            continue;
+        }
+        *link = subject.throttle_next;
+        subject.throttle_next = nullptr;
+        subject.throttle_held = false;
+        // Compared with the last value sent, which may be newer than the held
+        // change if a later one went out directly
+        if (!significant(policy, subject, subject.scores.data(), subject.throttle_count)) continue;
+        if (now != UINT64_MAX) subject.last_send_ns = now;
+        ++stats_.released;
+        send(subject.throttle_subject_id, subject, static_cast<size_t>(subject.throttle_count));
+    }
+    held_tail_ = last_kept;
+}
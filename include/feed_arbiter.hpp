@@ -0,0 +1,98 @@
+// feed_arbiter.hpp
+#pragma once
+
+#include "udp_receiver.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct FeedArbiterStats {
+    std::array<uint64_t, 2> wins{};        // datagrams this feed delivered first
+    std::array<uint64_t, 2> duplicates{};  // late copies dropped
+    std::array<uint64_t, 2> missed{};      // datagrams the other feed delivered that never showed up here
+    std::array<uint64_t, 2> outstanding{}; // copies this feed still owes, until they age out of the window
+};
+
+// First-arrival arbitration between two feeds carrying the same datagram stream.
+//
+// The wire format has no sequence number, so each feed's own arrival order is
+// its sequence: every datagram a feed wins is appended to the other feed's
+// "expected" queue, and a datagram that matches an entry there (by length and
+// content hash) is that feed's late copy. Identical payloads sent twice stay
+// distinct because each entry is consumed once, oldest first.
+//
+// Entries are found through a hash index, so a lookup costs the same however
+// far one feed leads. An entry skipped over by a later match stays matchable,
+// so a copy that arrives reordered within its feed is still recognized as
+// late. An entry is forgotten, and counted as missed, once `window` datagrams
+// have arrived on either feed since it was queued.
+class FeedArbiter {
+public:
+    static constexpr size_t NUM_FEEDS = 2;
+    static constexpr size_t DEFAULT_WINDOW = 4096;
+
+    explicit FeedArbiter(size_t window = DEFAULT_WINDOW);
+
+    // True if this is the first copy of the datagram and it should be processed
+    bool accept(size_t feed, const uint8_t* data, size_t length);
+
+    FeedArbiterStats stats() const;
+
+private:
+    struct Entry {
+        uint64_t hash;
+        size_t length;
+        uint64_t arrival;     // arrivals_ when queued; ages the entry out
+        uint64_t older;       // seq + 1 of the next older entry in its bucket, 0 for none
+        bool consumed;
+    };
+
+    // Fixed-capacity FIFO indexed by a per-queue sequence number (slot =
+    // seq % window), with per-bucket chains from newest to oldest, so
+    // arbitration never allocates after construction. Sequence numbers below
+    // oldest have been evicted, which ends every chain that reaches them.
+    struct ExpectedQueue {
+        std::vector<Entry> ring;
+        std::vector<uint64_t> buckets;   // seq + 1 of the newest entry per hash bucket, 0 for none
+        uint64_t oldest = 0;
+        uint64_t next = 0;
+        size_t unconsumed = 0;
+    };
+
+    static uint64_t hashBytes(const uint8_t* data, size_t length);
+    // Drops entries queued window_ or more arrivals ago, counting unconsumed ones as missed on feed
+    void expire(size_t feed);
+
+    std::array<ExpectedQueue, NUM_FEEDS> expected_;
+    size_t window_;
+    size_t bucket_mask_;
+    uint64_t arrivals_ = 0;
+    FeedArbiterStats stats_;
+};
+
+// Joins the A and B multicast groups on two sockets and multiplexes them on one
+// thread, passing only first arrivals on to the batch callback.
+class DualFeedReceiver {
+public:
+    DualFeedReceiver(const std::string& group_a, uint16_t port_a,
+                     const std::string& group_b, uint16_t port_b,
+                     const std::string& interface_name,
+                     size_t window = FeedArbiter::DEFAULT_WINDOW);
+
+    // Spin, pinning and SCHED_FIFO for both sockets and the polling thread;
+    // must be set before start()
+    void setTuning(const ReceiveTuning& tuning);
+    bool start(UdpReceiver::BatchCallback callback, size_t batch_size = UdpReceiver::DEFAULT_BATCH_SIZE);
+    void stop();
+
+    FeedArbiterStats stats() const { return arbiter_.stats(); }
+
+private:
+    std::array<UdpReceiver, FeedArbiter::NUM_FEEDS> feeds_;
+    FeedArbiter arbiter_;
+    ReceiveTuning tuning_;
+    std::atomic<bool> running_{false};
+};
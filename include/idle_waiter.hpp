@@ -0,0 +1,70 @@
+// idle_waiter.hpp
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Where a thread polling SpscRings goes when there is nothing to do. The
+// first SPIN_PASSES idle passes in a row only yield, so a short gap between
+// records costs no wakeup; after that the thread parks on a condition
+// variable until the other side calls notify(), or until a timeout for work
+// that is due by time rather than by data. The waiting thread raises a parked
+// flag and re-checks its rings before it sleeps, and notify() looks at that
+// flag after the publish, with a full fence on both sides, so a record
+// published during the park is never missed. A notify() that finds no one
+// parked costs the fence and one load; the mutex is only taken to wake a
+// parked thread.
+//
+// One thread waits on a given IdleWaiter; any number may notify it. In spin
+// mode the waiter never parks, trading a core for the wakeup latency.
+class IdleWaiter {
+public:
+    static constexpr unsigned SPIN_PASSES = 64;
+
+    void setSpin(bool enabled) { spin_ = enabled; }
+
+    // Waiting thread: a pass found work, so the next idle pass spins again
+    void busy() { idle_passes_ = 0; }
+
+    // Waiting thread, after a pass that found nothing: yields, or parks until
+    // ready() may have become true. timeout_ns bounds the park (0 = until
+    // notified). Returns early and spuriously; the caller re-polls.
+    template <typename Ready>
+    void idle(Ready&& ready, uint64_t timeout_ns) {
+        if (spin_ || ++idle_passes_ <= SPIN_PASSES) {
+            std::this_thread::yield();
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mtx_);
+        parked_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!ready()) {
+            if (timeout_ns > 0) {
+                cv_.wait_for(lock, std::chrono::nanoseconds(timeout_ns));
+            } else {
+                cv_.wait(lock);
+            }
+        }
+        parked_.store(false, std::memory_order_relaxed);
+    }
+
+    // Any thread, after publishing what the waiting thread polls for
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked_.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            cv_.notify_one();
+        }
+    }
+
+private:
+    std::atomic<bool> parked_{false};
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    unsigned idle_passes_ = 0;   // waiting thread only
+    bool spin_ = false;
+};
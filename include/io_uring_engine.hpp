@@ -0,0 +1,100 @@
+// io_uring_engine.hpp
+#pragma once
+
+#include "udp_receiver.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+struct IoUringStats {
+    uint64_t enters = 0;         // io_uring_enter() calls
+    uint64_t datagrams = 0;      // recv completions handed to the callback
+    uint64_t recv_arms = 0;      // multishot recv submissions (1 unless the kernel ends one)
+    uint64_t writes = 0;         // send SQEs submitted for egress
+    uint64_t bytes_written = 0;
+};
+
+// Single-thread io_uring driver for one UDP ingest socket plus TCP egress.
+// Ingest is one multishot recv backed by a registered provided-buffer ring, so
+// datagrams keep arriving without per-packet submissions. Bytes queued with
+// queueWrite() are coalesced and submitted as one send per loop iteration,
+// riding on the same io_uring_enter() that waits for input.
+// Uses the raw syscalls so no liburing dependency is needed.
+class IoUringEngine {
+public:
+    static constexpr unsigned DEFAULT_QUEUE_DEPTH = 64;
+    static constexpr unsigned NUM_RECV_BUFFERS = 256;   // power of two
+    static constexpr uint16_t RECV_BUFFER_GROUP = 0;
+
+    explicit IoUringEngine(unsigned queue_depth = DEFAULT_QUEUE_DEPTH);
+    ~IoUringEngine();
+
+    IoUringEngine(const IoUringEngine&) = delete;
+    IoUringEngine& operator=(const IoUringEngine&) = delete;
+
+    // Creates the ring and registers the receive buffers; false if io_uring is
+    // unavailable, with nothing left open, so a later call tries again
+    bool init();
+
+    // Drives ingest on an already bound udp_fd until stop(); blocks the caller
+    bool run(int udp_fd, const UdpReceiver::PacketCallback& callback);
+    void stop() { running_ = false; }
+
+    // Queues bytes for fd; they go out on the next loop iteration or flushWrites()
+    void queueWrite(int fd, const void* data, size_t len);
+    // Submits and waits until every queued byte has been written
+    bool flushWrites();
+
+    const IoUringStats& stats() const { return stats_; }
+
+private:
+    // Unmaps the rings and closes ring_fd_, leaving the engine uninitialized
+    void teardown();
+    io_uring_sqe* getSqe();
+    bool enter(unsigned min_complete, bool with_timeout);
+    void armRecv(int udp_fd);
+    void submitPendingWrite();
+    void handleWriteCompletion(int res);
+    void recycleBuffer(uint16_t bid);
+
+    int ring_fd_ = -1;
+    unsigned queue_depth_;
+    std::atomic<bool> running_{false};
+    IoUringStats stats_;
+
+    // Mapped ring state
+    void* sq_ring_ = nullptr;
+    void* cq_ring_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    size_t cq_ring_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_mask_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned* cq_mask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned to_submit_ = 0;
+
+    // Provided receive buffers
+    io_uring_buf_ring* buf_ring_ = nullptr;
+    size_t buf_ring_size_ = 0;
+    std::vector<uint8_t> recv_buffers_;
+    uint16_t buf_tail_ = 0;
+
+    // Egress double buffer: callbacks fill pending_ while inflight_ is being sent
+    int write_fd_ = -1;
+    std::vector<uint8_t> pending_;
+    std::vector<uint8_t> inflight_;
+    size_t inflight_offset_ = 0;
+    bool write_inflight_ = false;
+    bool write_failed_ = false;
+};
@@ -5,6 +5,7 @@
 #include <chrono>
 #include <fstream>
 #include <string>
+#include <ctime>
 #include "types.hpp"
 
 // Timestamp resolution: nanoseconds
@@ -13,6 +14,27 @@ inline uint64_t now_ns() {
         std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
+// Kernel socket timestamps are CLOCK_REALTIME; shift them onto the now_ns() clock
+// so they line up with t_recv and friends. The offset between the two clocks
+// costs two clock_gettime() calls, so each thread measures it once and again
+// only when the timestamps it converts have moved a second past the last
+// measurement, or back before it (the wall clock was stepped).
+inline uint64_t realtime_to_steady_ns(const timespec& ts) {
+    constexpr int64_t REFRESH_NS = 1000000000LL;
+    thread_local int64_t offset = 0;
+    thread_local int64_t measured_at = 0;   // realtime of the last measurement, 0 = never
+    const int64_t real = static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+    if (measured_at == 0 || real - measured_at >= REFRESH_NS || real < measured_at - REFRESH_NS) {
+        timespec real_now, mono_now;
+        clock_gettime(CLOCK_REALTIME, &real_now);
+        clock_gettime(CLOCK_MONOTONIC, &mono_now);
+        offset = (static_cast<int64_t>(real_now.tv_sec) - mono_now.tv_sec) * 1000000000LL
+               + (real_now.tv_nsec - mono_now.tv_nsec);
+        measured_at = static_cast<int64_t>(real_now.tv_sec) * 1000000000LL + real_now.tv_nsec;
+    }
+    return static_cast<uint64_t>(real - offset);
+}
+
 // struct LatencySample {
 //     uint32_t subject_id;
 //     uint64_t t_recv;
@@ -2,8 +2,108 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
+#include <iterator>
 #include "types.hpp"
+#include "wire_schema.hpp"
 
 // Parses a binary Source Endpoint packet into ProcessedMessage.
 // Returns true if successful, false if format/length is invalid.
 bool parse_data_packet(const uint8_t* data, size_t len, ProcessedMessage& out_msg);
+
+// Level records of one packet, left in network byte order in the receive
+// buffer and decoded one DataLevel at a time as they are read.
+class UpdateView {
+public:
+    static constexpr size_t RECORD_SIZE = wire::LevelRecord::SIZE;
+
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = DataLevel;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = DataLevel;
+
+        explicit iterator(const uint8_t* p) : p_(p) {}
+        DataLevel operator*() const { return decode(p_); }
+        iterator& operator++() { p_ += RECORD_SIZE; return *this; }
+        iterator operator++(int) { iterator old = *this; p_ += RECORD_SIZE; return old; }
+        bool operator==(const iterator& other) const { return p_ == other.p_; }
+        bool operator!=(const iterator& other) const { return p_ != other.p_; }
+
+    private:
+        const uint8_t* p_;
+    };
+
+    UpdateView() = default;
+    UpdateView(const uint8_t* records, uint16_t count) : records_(records), count_(count) {}
+
+    // Raw records in wire order
+    const uint8_t* data() const { return records_; }
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    DataLevel operator[](size_t i) const { return decode(records_ + i * RECORD_SIZE); }
+    iterator begin() const { return iterator(records_); }
+    iterator end() const { return iterator(records_ + count_ * RECORD_SIZE); }
+
+    static DataLevel decode(const uint8_t* p) {
+        DataLevel lvl;
+        wire::decode_level(p, lvl);
+        return lvl;
+    }
+
+private:
+    const uint8_t* records_ = nullptr;
+    uint16_t count_ = 0;
+};
+
+// Non-owning counterpart of ProcessedMessage: refers into the packet buffer,
+// so it is only valid while that buffer is, and parsing it never allocates.
+struct [[nodiscard]] PacketView {
+    uint32_t subject_id = 0;
+    UpdateView updates;
+    uint64_t t_kernel_rx = 0;
+};
+
+constexpr size_t MSG_LEN_FIELD_SIZE = wire::MessageHeader::MsgLen::end;  // msg_len counts the bytes after this field
+constexpr size_t MSG_HEADER_SIZE = wire::MessageHeader::SIZE;
+
+// Same validation as parse_data_packet: false if the header or any level
+// record is cut short.
+inline bool parse_packet_view(const uint8_t* data, size_t len, PacketView& out_view) {
+    if (len < MSG_HEADER_SIZE) return false;
+
+    uint16_t update_count = wire::MessageHeader::UpdateCount::load(data);
+    if (wire::message_size(update_count) > len) return false;
+
+    out_view.subject_id = wire::MessageHeader::SubjectId::load(data);
+    out_view.updates = UpdateView(data + MSG_HEADER_SIZE, update_count);
+    return true;
+}
+
+// A datagram carries one or more messages back to back, each framed by its
+// msg_len. Every frame must be complete and its msg_len must match its update
+// count exactly; otherwise the whole datagram is rejected before anything is
+// delivered, so a corrupt datagram never half-applies. Calls
+// fn(const PacketView&) once per message, in order.
+template <typename Fn>
+inline bool for_each_message(const uint8_t* data, size_t len, Fn&& fn) {
+    size_t off = 0;
+    do {
+        if (len - off < MSG_HEADER_SIZE) return false;
+        uint32_t msg_len = wire::MessageHeader::MsgLen::load(data + off);
+        size_t expected = wire::msg_len_for(wire::MessageHeader::UpdateCount::load(data + off));
+        if (msg_len != expected || msg_len > len - off - MSG_LEN_FIELD_SIZE) return false;
+        off += MSG_LEN_FIELD_SIZE + msg_len;
+    } while (off < len);
+
+    for (off = 0; off < len;) {
+        size_t frame_len = MSG_LEN_FIELD_SIZE + wire::MessageHeader::MsgLen::load(data + off);
+        PacketView view;
+        (void)parse_packet_view(data + off, frame_len, view); // already validated above
+        fn(view);
+        off += frame_len;
+    }
+    return true;
+}
@@ -0,0 +1,182 @@
+// pipeline.hpp
+#pragma once
+
+#include "idle_waiter.hpp"
+#include "spsc_ring.hpp"
+#include "tcp_sender.hpp"
+#include "types.hpp"
+#include "udp_receiver.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+// One received datagram, copied off the receive thread's buffers
+struct DatagramRecord {
+    uint64_t kernel_rx_ns;
+    uint32_t length;
+    uint8_t data[UdpReceiver::MAX_DATAGRAM_SIZE];
+};
+
+// One output record on its way to the socket
+struct EgressRecord {
+    uint32_t subject_id;
+    uint32_t count;
+    int64_t values[TcpSender::MAX_RECORD_VALUES];
+};
+
+// Output buffer of one processing thread, and the Sender it hands to
+// emit_scores(): records and latency samples are queued for an egress thread
+// instead of being written here. Each ring is FIFO, so the records of one
+// producer reach the socket in the order it queued them. Every push notifies
+// the egress thread's IdleWaiter, in case it is parked.
+class EgressQueue {
+public:
+    static constexpr size_t RECORD_CAPACITY = 4096;
+    static constexpr size_t LATENCY_CAPACITY = 4096;
+
+    EgressQueue(bool record_analytics, IdleWaiter& consumer);
+
+    // Producer side. A full ring makes the producer wait, parked once the
+    // wait outlasts a spin, until the egress thread has drained it.
+    void sendScores(uint32_t subject_id, const int64_t* scores, size_t count, uint64_t* send_timestamp_ns);
+    void logLatency(const LatencySample& sample);
+    bool recordAnalytics() const { return record_analytics_; }
+    void setSpin(bool enabled) { room_.setSpin(enabled); }
+
+    // Egress side: writes the records queued so far in one send(), then their
+    // latency rows, so file I/O never delays a send. False if both were empty.
+    bool drain(TcpSender& sender);
+    bool empty() const { return records_->size() == 0 && latency_->size() == 0; }
+
+    size_t depth() const { return records_->size(); }
+    // Peak depth seen by the egress thread at the start of a drain
+    size_t maxDepth() const { return max_depth_.load(std::memory_order_relaxed); }
+    uint64_t stalls() const { return stalls_.load(std::memory_order_relaxed); }   // records that waited for room
+    size_t latencyDepth() const { return latency_->size(); }
+
+private:
+    bool record_analytics_;
+    IdleWaiter& consumer_;   // the egress thread's
+    IdleWaiter room_;        // the producer's, while a ring is full
+    std::unique_ptr<SpscRing<EgressRecord, RECORD_CAPACITY>> records_;
+    std::unique_ptr<SpscRing<LatencySample, LATENCY_CAPACITY>> latency_;
+    std::atomic<size_t> max_depth_{0};
+    std::atomic<uint64_t> stalls_{0};
+};
+
+// Records a new peak for a queue's consumer, the only writer of max_depth.
+// Producers never sample depth: that would read the consumer's index on every
+// push, the shared-line access the rings' cached indices exist to avoid.
+inline void raise_max_depth(std::atomic<size_t>& max_depth, size_t depth) {
+    if (depth > max_depth.load(std::memory_order_relaxed)) max_depth.store(depth, std::memory_order_relaxed);
+}
+
+// Egress thread body: drains the queues in turn into sender until done is set
+// and all of them are empty. Parks on waiter, the IdleWaiter the queues were
+// built with, while they are empty; whoever sets done must notify it.
+void run_egress(EgressQueue* const* queues, size_t count, TcpSender& sender, const std::atomic<bool>& done,
+                IdleWaiter& waiter);
+
+struct PipelineStats {
+    size_t ingest_depth = 0;         // datagrams waiting for the compute stage
+    size_t ingest_max_depth = 0;
+    uint64_t ingest_dropped = 0;     // datagrams dropped because the ingest ring was full
+    uint64_t ingest_oversized = 0;   // datagrams dropped as larger than an ingest record
+    size_t egress_depth = 0;         // records waiting for the egress stage
+    size_t egress_max_depth = 0;
+    uint64_t egress_stalls = 0;      // records the compute stage had to wait to queue
+    size_t latency_depth = 0;        // latency samples waiting to be written
+};
+
+// Three-stage mode: the receive thread only drains the socket into the
+// ingest ring; a compute thread parses, updates books and scores; an egress
+// thread does the blocking TCP sends and latency trace writes. The stages are
+// joined by SpscRings of fixed-size records, so a slow send or file flush
+// backs up the egress ring, then the compute stage, and never the socket.
+//
+// When the ingest ring is full the receive thread drops the datagram and
+// counts it rather than stop reading (setBlockWhenFull() makes it wait
+// instead, for replays). A datagram larger than a record is dropped and
+// counted too. When the egress ring is full the compute stage waits.
+// Each stage's queue depth is readable at any time through stats().
+//
+// An idle compute or egress thread spins briefly, then parks on an
+// IdleWaiter until the stage before it publishes, so an idle pipeline does
+// not hold cores. The compute stage also wakes every setIdleWake() interval
+// so batch_end() can release held scores on time. setSpin() keeps every
+// stage polling instead, for the lowest wakeup latency.
+class Pipeline {
+public:
+    static constexpr size_t INGEST_CAPACITY = 1024;
+
+    explicit Pipeline(TcpSender& sender);
+    ~Pipeline();
+
+    // Receive stage. False if the datagram was dropped.
+    bool pushDatagram(const uint8_t* data, size_t length, uint64_t kernel_rx_ns);
+    void setBlockWhenFull(bool enabled) { block_when_full_ = enabled; }
+    // No more datagrams will be pushed; the compute stage drains and returns
+    void finishIngest();
+
+    // Before the stages start: longest an idle compute stage parks (0 = until
+    // a datagram or finishIngest()), and whether idle stages poll instead
+    void setIdleWake(uint64_t ns) { idle_wake_ns_ = ns; }
+    void setSpin(bool enabled);
+
+    // Compute stage, run on its own thread until finishIngest() and the ring
+    // is empty. handler(data, length, kernel_rx_ns) takes each datagram;
+    // batch_end() runs whenever the ring has been drained, so a batch is
+    // whatever queued up while the previous one was processed, and again on
+    // every idle pass and idle wake so held scores are released on time.
+    template <typename Handler, typename BatchEnd>
+    void runCompute(Handler&& handler, BatchEnd&& batch_end);
+    EgressQueue& egress() { return egress_; }
+
+    // Egress stage: starts its thread; stopEgress() drains both rings first
+    void startEgress();
+    void stopEgress();
+
+    PipelineStats stats() const;
+
+private:
+    TcpSender& sender_;
+    IdleWaiter compute_waiter_;   // the compute stage, parked on an empty ingest ring
+    IdleWaiter egress_waiter_;    // the egress stage, parked on empty egress rings
+    IdleWaiter ingest_room_;      // the receive stage, parked on a full ingest ring
+    EgressQueue egress_;
+    std::unique_ptr<SpscRing<DatagramRecord, INGEST_CAPACITY>> ingest_;
+    std::thread egress_thread_;
+    std::atomic<bool> ingest_done_{false};
+    std::atomic<bool> egress_done_{false};
+    bool block_when_full_ = false;
+    uint64_t idle_wake_ns_ = 0;
+
+    std::atomic<uint64_t> ingest_dropped_{0};    // written by the receive stage
+    std::atomic<uint64_t> ingest_oversized_{0};  // written by the receive stage
+    std::atomic<size_t> ingest_max_depth_{0};    // written by the compute stage
+};
+
+template <typename Handler, typename BatchEnd>
+void Pipeline::runCompute(Handler&& handler, BatchEnd&& batch_end) {
+    for (;;) {
+        bool drained_any = false;
+        while (const DatagramRecord* rec = ingest_->front()) {
+            if (!drained_any) raise_max_depth(ingest_max_depth_, ingest_->consumerDepth());
+            handler(rec->data, static_cast<size_t>(rec->length), rec->kernel_rx_ns);
+            ingest_->pop();
+            drained_any = true;
+        }
+        // Only a blocking receive stage ever waits for room
+        if (drained_any && block_when_full_) ingest_room_.notify();
+        batch_end();
+        if (drained_any) {
+            compute_waiter_.busy();
+            continue;
+        }
+        if (ingest_done_.load(std::memory_order_acquire) && ingest_->size() == 0) break;
+        compute_waiter_.idle(
+            [this] { return ingest_->size() > 0 || ingest_done_.load(std::memory_order_acquire); }, idle_wake_ns_);
+    }
+}
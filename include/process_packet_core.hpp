@@ -2,64 +2,243 @@
 #pragma once
 
 #include <iostream>
-#include <unordered_set>
 #include "types.hpp"
 #include "data_book.hpp"
 #include "composite_score_calculator.hpp"
+#include "score_batch.hpp"
+#include "emission_throttle.hpp"
 #include "tcp_sender.hpp"
 #include "logger.hpp"
 
-// Apply processed message to data book and TCP, and log timing
+static_assert(TcpSender::MAX_RECORD_VALUES >= MAX_SCORE_OUTPUTS + ScoreAnalytics::NUM_FIELDS,
+              "a record must hold every score and the analytics");
+
+// Writes one record for the subject and records it as the last one sent. If
+// the sender records analytics, the subject's ScoreAnalytics take the first
+// score and follow the scores in the record.
+template <typename Sender>
+inline void send_scores(
+    uint32_t subject_id,
+    SubjectRecord& subject,
+    const int64_t* scaled_scores,
+    size_t count,
+    Sender* sender,
+    uint64_t* send_timestamp_ns)
+{
+    if (sender->recordAnalytics()) {
+        // Analytics follow the first score, one sample per send
+        subject.analytics.push(scaled_scores[0]);
+        int64_t values[TcpSender::MAX_RECORD_VALUES];
+        for (size_t i = 0; i < count; ++i) values[i] = scaled_scores[i];
+        subject.analytics.write(values + count);
+        sender->sendScores(subject_id, values, count + ScoreAnalytics::NUM_FIELDS, send_timestamp_ns);
+    } else {
+        sender->sendScores(subject_id, scaled_scores, count, send_timestamp_ns);
+    }
+    subject.sent = true;
+    for (size_t i = 0; i < count; ++i) subject.last_sent_scores[i] = scaled_scores[i];
+}
+
+// Sends a freshly computed record of count scores if it is the subject's
+// first or any score differs from the last one sent, and records the
+// message's latency sample. With a throttle, a change must also pass the
+// subject's EmissionPolicy; a held change is sent later by the throttle.
+// Sender is TcpSender, or an EgressQueue to hand the record to an egress
+// thread.
+template <typename Sender>
+inline void emit_scores(
+    uint32_t subject_id,
+    SubjectRecord& subject,
+    const int64_t* scaled_scores,
+    size_t count,
+    uint64_t t_kernel_rx,
+    uint64_t t_recv,
+    uint64_t t_parsed,
+    uint64_t t_calc_end,
+    int num_updates,
+    std::vector<LatencySample>* latency_log,
+    std::ostream* out,
+    Sender* sender,
+    EmissionThrottle* throttle)
+{
+    if (!sender) return;
+    bool changed = !subject.sent;
+    for (size_t i = 0; i < count; ++i) changed |= subject.last_sent_scores[i] != scaled_scores[i];
+    if (!changed) return;
+
+    if (throttle) {
+        if (!subject.sent) {
+            subject.last_send_ns = t_calc_end;
+        } else if (throttle->admit(subject_id, subject, scaled_scores, count, t_calc_end) !=
+                   EmissionThrottle::Decision::Send) {
+            return;
+        }
+    }
+
+    send_scores(subject_id, subject, scaled_scores, count, sender, &t_calc_end);
+
+    uint64_t t_sent = now_ns();
+
+    if (latency_log) {
+        LatencySample sample;
+
+        sample.subject_id = subject_id;
+        sample.t_kernel_rx = static_cast<int64_t>(t_kernel_rx);
+        sample.t_recv = t_recv;
+        sample.t_parsed = t_parsed;
+        sample.t_calc_start = t_parsed;
+        sample.t_calc_end = t_calc_end;
+        sample.t_sent = t_sent;
+        sample.num_updates = num_updates;
+
+        sender->logLatency(sample);
+    }
+
+    if (out) {
+        *out << "[main] SID=" << subject_id;
+        for (size_t i = 0; i < count; ++i) {
+            *out << " Composite-score=" << (scaled_scores[i] / 1e9)
+                 << " scaled=" << scaled_scores[i];
+        }
+        *out << "\n";
+    }
+}
+
+// Apply processed message to data book and TCP, and log timing.
+// Message is ProcessedMessage or the non-owning PacketView; both expose
+// subject_id, t_kernel_rx and an iterable updates range of DataLevel.
+// Calculator is a ScoringEngine<Policy> or a RegisteredScorer; throttle may be nullptr.
+// The book and the last score sent for the subject live in one SubjectRecord,
+// so each message costs one table lookup. A message that writes none of the
+// levels the calculator reads cannot change the score, so once the subject has
+// been scored it is dropped after the book update: no calculation, no change
+// check, nothing sent.
+template <typename Message, typename Calculator, typename Sender>
 inline void process_decoded_packet(
-    const ProcessedMessage& msg,
+    const Message& msg,
     DataBookManager& book_manager,
-    CompositeScoreCalculator& calculator,
+    const Calculator& calculator,
     std::vector<LatencySample>* latency_log,
     std::ostream* out,
     int packet_id,
-    TcpSender* sender)
+    Sender* sender,
+    EmissionThrottle* throttle = nullptr)
 {
     (void)packet_id; // Suppress unused parameter warning - available for debugging/logging
-    static std::unordered_set<uint32_t> seen_sids;
 
     uint64_t t_recv = now_ns();
 
-    DataBook& book = book_manager.getOrCreateBook(msg.subject_id);
-    for (const auto& u : msg.updates) {
-        book.applyUpdate(u);
-    }
+    SubjectRecord& subject = book_manager.getOrCreate(msg.subject_id);
+    // One seqlock write for the whole message
+    const DirtyLevels dirty = subject.book.applyUpdates(msg.updates);
+    if (subject.scored && !dirty.intersects(calculator.dependencies())) return;
+
+    uint64_t t_parsed = now_ns();
+    int64_t scaled_score = calculator.calculateCompositeScore(subject.book);
+    subject.scores[0] = scaled_score;
+    subject.scored = true;
+    uint64_t t_calc_end = now_ns();
+
+    emit_scores(msg.subject_id, subject, &scaled_score, 1, msg.t_kernel_rx, t_recv, t_parsed, t_calc_end,
+                static_cast<int>(msg.updates.size()), latency_log, out, sender, throttle);
+}
+
+// process_decoded_packet for a ScoreSet: every output of the set is computed
+// from one snapshot of the book and sent as one record, which goes out when
+// any of the outputs changed.
+template <typename Message, typename Sender>
+inline void process_decoded_packet(
+    const Message& msg,
+    DataBookManager& book_manager,
+    const ScoreSet& score_set,
+    std::vector<LatencySample>* latency_log,
+    std::ostream* out,
+    Sender* sender,
+    EmissionThrottle* throttle = nullptr)
+{
+    uint64_t t_recv = now_ns();
+
+    SubjectRecord& subject = book_manager.getOrCreate(msg.subject_id);
+    const DirtyLevels dirty = subject.book.applyUpdates(msg.updates);
+    if (subject.scored && !dirty.intersects(score_set.dependencies())) return;
 
     uint64_t t_parsed = now_ns();
-    int64_t scaled_score = calculator.calculateCompositeScore(book);
+    score_set.calculateScores(subject.book, subject.scores.data());
+    subject.scored = true;
     uint64_t t_calc_end = now_ns();
 
-    if (sender) {
-        bool is_first_time = seen_sids.insert(msg.subject_id).second;
-        if (is_first_time || sender->hasScoreChanged(msg.subject_id, scaled_score)) {
-            CompositeScoreMessage tcp_msg{msg.subject_id, scaled_score};
-            sender->send(tcp_msg, &t_calc_end);
-
-            uint64_t t_sent = now_ns();
-
-            if (latency_log) {
-                LatencySample sample;
-                
-                sample.subject_id = msg.subject_id;
-                sample.t_recv = t_recv;
-                sample.t_parsed = t_parsed;
-                sample.t_calc_start = t_parsed;   
-                sample.t_calc_end = t_calc_end;
-                sample.t_sent = t_sent;
-                sample.num_updates = static_cast<int>(msg.updates.size());
-
-                append_latency_sample(sample);
-            }
-
-            if (out) {
-                *out << "[main] SID=" << msg.subject_id
-                     << " Composite-score=" << (scaled_score / 1e9)
-                     << " scaled=" << scaled_score << "\n";
-            }
+    emit_scores(msg.subject_id, subject, subject.scores.data(), score_set.size(), msg.t_kernel_rx, t_recv,
+                t_parsed, t_calc_end, static_cast<int>(msg.updates.size()), latency_log, out, sender, throttle);
+}
+
+// Scores everything queued in batch in one pass, then emits in queue order.
+// Calculator is anything process_decoded_packet takes, or a ScoreSet;
+// throttle may be nullptr.
+template <typename Calculator, typename Sender>
+inline void flush_score_batch(
+    ScoreBatch& batch,
+    const Calculator& calculator,
+    std::vector<LatencySample>* latency_log,
+    std::ostream* out,
+    Sender* sender,
+    EmissionThrottle* throttle)
+{
+    if (batch.empty()) return;
+    uint64_t t_calc_end = 0;
+    bool timed = false;
+    batch.flush(calculator, [&](const PendingScore& p, const int64_t* scaled_scores, size_t count) {
+        if (!timed) {
+            t_calc_end = now_ns();
+            timed = true;
         }
+        emit_scores(p.subject_id, *p.subject, scaled_scores, count, p.t_kernel_rx, p.t_recv, p.t_parsed,
+                    t_calc_end, p.num_updates, latency_log, out, sender, throttle);
+    });
+}
+
+// Batched counterpart of process_decoded_packet: applies the message and
+// queues its subject in batch instead of scoring it; the caller runs
+// flush_score_batch() once the receive batch is done. Without conflation the
+// output is the same as process_decoded_packet's, message for message; with
+// it, a subject already queued just takes the new updates.
+template <typename Message, typename Calculator, typename Sender>
+inline void stage_decoded_packet(
+    const Message& msg,
+    DataBookManager& book_manager,
+    const Calculator& calculator,
+    ScoreBatch& batch,
+    std::vector<LatencySample>* latency_log,
+    std::ostream* out,
+    Sender* sender,
+    EmissionThrottle* throttle)
+{
+    uint64_t t_recv = now_ns();
+
+    SubjectRecord& subject = book_manager.getOrCreate(msg.subject_id);
+    if (subject.batch_slot >= 0 && batch.conflating()) {
+        subject.book.applyUpdates(msg.updates);
+        batch.merge(subject, static_cast<int>(msg.updates.size()));
+        return;
+    }
+    // A queued subject must be scored on its current book before this message
+    // changes it
+    if (subject.batch_slot >= 0 || batch.full()) {
+        flush_score_batch(batch, calculator, latency_log, out, sender, throttle);
     }
+
+    const DirtyLevels dirty = subject.book.applyUpdates(msg.updates);
+    if (subject.scored && !dirty.intersects(calculator.dependencies())) return;
+
+    batch.add(PendingScore{msg.subject_id, &subject, msg.t_kernel_rx, t_recv, now_ns(),
+                           static_cast<int>(msg.updates.size())});
+}
+
+// Sends the latest scores of every held subject whose rate-limit interval has
+// ended (all of them at shutdown, with now = UINT64_MAX)
+template <typename Sender>
+inline void release_held_scores(EmissionThrottle& throttle, uint64_t now, Sender* sender) {
+    throttle.releaseDue(now, [&](uint32_t subject_id, SubjectRecord& subject, size_t count) {
+        uint64_t t_sent = 0;
+        send_scores(subject_id, subject, subject.scores.data(), count, sender, &t_sent);
+    });
 }
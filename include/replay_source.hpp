@@ -0,0 +1,99 @@
+// replay_source.hpp
+#pragma once
+
+#include "logger.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// How fast ReplaySource hands frames to the handler
+struct ReplayPacing {
+    enum class Mode {
+        MaxSpeed,    // back to back, no waiting
+        FixedRate,   // rate_pps frames per second
+        Original     // inter-arrival gaps from the capture's timestamp sidecar
+    };
+    Mode mode = Mode::MaxSpeed;
+    double rate_pps = 0.0;
+};
+
+struct ReplayStats {
+    uint64_t frames = 0;       // frames handed to the handler
+    uint64_t bytes = 0;
+    uint64_t elapsed_ns = 0;   // first frame to last handler return
+    uint64_t late_frames = 0;  // paced modes: frames that could not be sent on schedule
+};
+
+// Socket-free ingest for profiling: memory-maps a capture of length-prefixed
+// datagrams (the test_data/input_packets.bin format, each frame being the
+// 4-byte big-endian msg_len followed by msg_len bytes, exactly as sent on the
+// wire) and walks it in place, passing each frame to the same handler
+// signature UdpReceiver::run() uses.
+//
+// Original timing needs arrival times, which the capture format does not
+// carry: they are read from "<capture>.ts", one nanosecond timestamp per line
+// per frame (any epoch; only the differences are used).
+class ReplaySource {
+public:
+    explicit ReplaySource(const std::string& path);
+    ~ReplaySource();
+
+    ReplaySource(const ReplaySource&) = delete;
+    ReplaySource& operator=(const ReplaySource&) = delete;
+
+    // Maps the capture and indexes its frames; loads the timestamp sidecar when
+    // pacing needs it. False if the file is missing, truncated or has no sidecar.
+    bool open(const ReplayPacing& pacing = {});
+
+    // Replays the capture `loops` times (0 = until stop()); blocks the caller.
+    // Handler is invoked as handler(const uint8_t* data, size_t length, uint64_t kernel_rx_ns)
+    // with kernel_rx_ns = 0, since nothing went through a socket.
+    template <typename Handler>
+    bool run(Handler&& handler, uint64_t loops = 1);
+    void stop() { running_ = false; }
+
+    size_t numFrames() const { return frame_offsets_.size(); }
+    const ReplayStats& stats() const { return stats_; }
+
+private:
+    // Offset of frame i from the start of the replay, in ns
+    uint64_t scheduleOffset(size_t frame, uint64_t loop) const;
+    // Sleeps or spins until the now_ns() clock reaches deadline; false if already late
+    static bool waitUntil(uint64_t deadline_ns);
+    void unmap();
+
+    std::string path_;
+    const uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    std::vector<size_t> frame_offsets_;
+    std::vector<uint64_t> arrival_offsets_;  // Original mode: ns since the first frame
+    uint64_t loop_span_ns_ = 0;               // duration of one pass through the capture
+    ReplayPacing pacing_;
+    std::atomic<bool> running_{false};
+    ReplayStats stats_;
+};
+
+template <typename Handler>
+bool ReplaySource::run(Handler&& handler, uint64_t loops) {
+    if (!base_ || frame_offsets_.empty()) return false;
+
+    const bool paced = pacing_.mode != ReplayPacing::Mode::MaxSpeed;
+    running_ = true;
+    const uint64_t start = now_ns();
+    for (uint64_t loop = 0; running_ && (loops == 0 || loop < loops); ++loop) {
+        for (size_t i = 0; i < frame_offsets_.size() && running_; ++i) {
+            if (paced && !waitUntil(start + scheduleOffset(i, loop))) ++stats_.late_frames;
+
+            const uint8_t* frame = base_ + frame_offsets_[i];
+            size_t length = (i + 1 < frame_offsets_.size() ? frame_offsets_[i + 1] : size_) - frame_offsets_[i];
+            handler(frame, length, 0);
+            ++stats_.frames;
+            stats_.bytes += length;
+        }
+    }
+    stats_.elapsed_ns = now_ns() - start;
+    running_ = false;
+    return true;
+}
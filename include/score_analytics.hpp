@@ -0,0 +1,106 @@
+// score_analytics.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Running statistics of one subject's emitted score, so consumers read them
+// from the output record instead of recomputing them from the score stream.
+// Every value is in the score's fixed point (scaled by 1e9) and integer only:
+//   ewma      exponentially weighted average, weight 1/EWMA_DIVISOR per sample,
+//             kept scaled by EWMA_DIVISOR so the step's remainder carries over
+//             and a constant input is reached exactly
+//   min, max  over the last WINDOW emitted scores
+//   variance  population variance over the same window
+// push() is O(1): min and max come from monotonic queues over a ring of the
+// window's scores, and the variance from a running sum and sum of squares
+// that are adjusted exactly as samples enter and leave. The sample count
+// saturates at WINDOW, and the ring and queues are indexed by a separate 8-bit
+// sample number that wraps, so a subject can emit any number of scores.
+class ScoreAnalytics {
+public:
+    static constexpr uint32_t WINDOW = 16;
+    static constexpr int64_t EWMA_DIVISOR = 16;
+    static constexpr size_t NUM_FIELDS = 4;   // ewma, min, max, variance
+
+    void push(int64_t score) {
+        const uint8_t seq = seq_;
+        int64_t& slot = window_[seq % WINDOW];
+
+        // ewma += (score - ewma) / D, in units of 1/D: truncating the step
+        // itself would stall up to D - 1 units short of a constant input
+        if (count_ == 0) {
+            ewma_scaled_ = score * EWMA_DIVISOR;
+        } else {
+            ewma_scaled_ += score - ewma_scaled_ / EWMA_DIVISOR;
+        }
+
+        if (count_ == WINDOW) {
+            const int64_t old = slot;
+            sum_ -= old;
+            sum_squares_ -= static_cast<__int128>(old) * old;
+            // The sample leaving the window can only be at a queue's front
+            if (min_.size && min_.front() == static_cast<uint8_t>(seq - WINDOW)) min_.popFront();
+            if (max_.size && max_.front() == static_cast<uint8_t>(seq - WINDOW)) max_.popFront();
+        }
+        sum_ += score;
+        sum_squares_ += static_cast<__int128>(score) * score;
+
+        while (min_.size && window_[min_.back() % WINDOW] >= score) min_.popBack();
+        while (max_.size && window_[max_.back() % WINDOW] <= score) max_.popBack();
+        slot = score;
+        min_.pushBack(seq);
+        max_.pushBack(seq);
+        ++seq_;
+        if (count_ < WINDOW) ++count_;
+    }
+
+    // Samples in the window: the number pushed, up to WINDOW
+    uint32_t count() const { return count_; }
+    int64_t ewma() const { return ewma_scaled_ / EWMA_DIVISOR; }
+    int64_t min() const { return count_ ? window_[min_.front() % WINDOW] : 0; }
+    int64_t max() const { return count_ ? window_[max_.front() % WINDOW] : 0; }
+
+    int64_t variance() const {
+        const int64_t n = count_;
+        if (n == 0) return 0;
+        // n * sum(x^2) - sum(x)^2 over n^2 is in scaled^2 units; one more
+        // division by 1e9 brings it back to the scores' fixed point
+        const __int128 spread = n * sum_squares_ - static_cast<__int128>(sum_) * sum_;
+        return static_cast<int64_t>(spread / (n * n) / 1000000000);
+    }
+
+    // ewma, min, max, variance into out[0..NUM_FIELDS)
+    void write(int64_t* out) const {
+        out[0] = ewma();
+        out[1] = min();
+        out[2] = max();
+        out[3] = variance();
+    }
+
+private:
+    static_assert(256 % WINDOW == 0, "8-bit sample numbers must map onto the ring");
+
+    // Sample numbers (mod 256) of the window's candidates in arrival order,
+    // their scores monotonic from the front
+    struct MonotonicQueue {
+        uint8_t items[WINDOW];
+        uint8_t head = 0;
+        uint8_t size = 0;
+
+        uint8_t front() const { return items[head]; }
+        uint8_t back() const { return items[(head + size - 1) % WINDOW]; }
+        void popFront() { head = (head + 1) % WINDOW; --size; }
+        void popBack() { --size; }
+        void pushBack(uint8_t seq) { items[(head + size++) % WINDOW] = seq; }
+    };
+
+    __int128 sum_squares_ = 0;
+    int64_t sum_ = 0;
+    int64_t ewma_scaled_ = 0;   // ewma * EWMA_DIVISOR
+    int64_t window_[WINDOW] = {};
+    MonotonicQueue min_;
+    MonotonicQueue max_;
+    uint8_t seq_ = 0;     // sample number of the next push, mod 256
+    uint8_t count_ = 0;   // saturates at WINDOW
+};
@@ -0,0 +1,143 @@
+// score_batch.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "data_book.hpp"
+#include "composite_score_calculator.hpp"
+
+// Level 0 of a batch of books in structure-of-arrays form
+struct TopOfBookBatch {
+    static constexpr size_t CAPACITY = 256;
+
+    size_t count = 0;
+    alignas(32) int64_t demand_value[CAPACITY];
+    alignas(32) int64_t supply_value[CAPACITY];
+    alignas(32) int32_t demand_volume[CAPACITY];
+    alignas(32) int32_t supply_volume[CAPACITY];
+};
+
+// TopOfBookMidpoint for every book of the batch into out[0..count). The AVX2
+// version computes four books per step in double precision; any lane whose
+// operands or products are not exact in a double (|x| >= 2^51), or whose book
+// is empty on both sides, is redone with the integer formula, so the result
+// is bit-exact either way.
+using TopOfBookScoreFn = void (*)(const TopOfBookBatch& batch, int64_t* out);
+
+void score_top_of_book_scalar(const TopOfBookBatch& batch, int64_t* out);
+void score_top_of_book_avx2(const TopOfBookBatch& batch, int64_t* out);
+
+// Best version this CPU supports, chosen once at startup
+void score_top_of_book(const TopOfBookBatch& batch, int64_t* out);
+const char* batch_scorer_name();
+
+// One subject waiting for its score; the timestamps are those of the first
+// message queued for it
+struct PendingScore {
+    uint32_t subject_id;
+    SubjectRecord* subject;
+    uint64_t t_kernel_rx;
+    uint64_t t_recv;
+    uint64_t t_parsed;
+    int num_updates;          // summed over every message conflated into this entry
+};
+
+// Subjects whose score inputs changed during a receive batch. Messages apply
+// their updates and queue their subject; flush() then scores every queued
+// subject in one pass and hands the results out in queue order.
+//
+// Without conflation a subject is queued at most once: a second message for
+// it must flush first, so every message is still scored against its own book
+// state. With conflation the second message only updates the book and joins
+// the queued entry, so the subject is scored and sent once per flush, from
+// its latest state.
+class ScoreBatch {
+public:
+    static constexpr size_t CAPACITY = TopOfBookBatch::CAPACITY;
+
+    bool empty() const { return count_ == 0; }
+    bool full() const { return count_ == CAPACITY; }
+    size_t size() const { return count_; }
+
+    void setConflate(bool enabled) { conflate_ = enabled; }
+    bool conflating() const { return conflate_; }
+    // Messages folded into an already queued entry since construction
+    uint64_t conflated() const { return conflated_; }
+    // Receive time of the oldest queued entry; only valid if !empty()
+    uint64_t oldestRecv() const { return entries_[0].t_recv; }
+
+    void add(const PendingScore& entry) {
+        entry.subject->batch_slot = static_cast<int16_t>(count_);
+        entries_[count_++] = entry;
+    }
+
+    // Folds one more message for an already queued subject into its entry
+    void merge(const SubjectRecord& subject, int num_updates) {
+        entries_[subject.batch_slot].num_updates += num_updates;
+        ++conflated_;
+    }
+
+    // Scores and clears the batch; emit(const PendingScore&, const int64_t*
+    // scores, size_t count) is called once per entry, after all scores are
+    // computed. Calculators that are the level-0 midpoint use the batched
+    // kernel; others, and ScoreSets, score one subject at a time.
+    template <typename Calculator, typename Emit>
+    void flush(const Calculator& calculator, Emit&& emit);
+
+private:
+    template <typename Calculator>
+    size_t score(const Calculator& calculator);
+    size_t score(const ScoreSet& score_set);
+
+    PendingScore entries_[CAPACITY];
+    size_t count_ = 0;
+    bool conflate_ = false;
+    uint64_t conflated_ = 0;
+    TopOfBookBatch top_;
+    alignas(32) int64_t scores_[CAPACITY];
+};
+
+// Fills each queued subject's scores; returns the outputs per subject
+template <typename Calculator>
+inline size_t ScoreBatch::score(const Calculator& calculator) {
+    if (calculator.isTopOfBookMidpoint()) {
+        for (size_t i = 0; i < count_; ++i) {
+            const TopOfBook t = entries_[i].subject->book.topOfBook();
+            top_.demand_value[i] = t.demand_value;
+            top_.supply_value[i] = t.supply_value;
+            top_.demand_volume[i] = t.demand_volume;
+            top_.supply_volume[i] = t.supply_volume;
+        }
+        top_.count = count_;
+        score_top_of_book(top_, scores_);
+        for (size_t i = 0; i < count_; ++i) entries_[i].subject->scores[0] = scores_[i];
+    } else {
+        for (size_t i = 0; i < count_; ++i) {
+            SubjectRecord& subject = *entries_[i].subject;
+            subject.scores[0] = calculator.calculateCompositeScore(subject.book);
+        }
+    }
+    return 1;
+}
+
+inline size_t ScoreBatch::score(const ScoreSet& score_set) {
+    for (size_t i = 0; i < count_; ++i) {
+        SubjectRecord& subject = *entries_[i].subject;
+        score_set.calculateScores(subject.book, subject.scores.data());
+    }
+    return score_set.size();
+}
+
+template <typename Calculator, typename Emit>
+inline void ScoreBatch::flush(const Calculator& calculator, Emit&& emit) {
+    if (count_ == 0) return;
+
+    const size_t outputs = score(calculator);
+    for (size_t i = 0; i < count_; ++i) {
+        SubjectRecord& subject = *entries_[i].subject;
+        subject.scored = true;
+        subject.batch_slot = -1;
+    }
+    for (size_t i = 0; i < count_; ++i) emit(entries_[i], entries_[i].subject->scores.data(), outputs);
+    count_ = 0;
+}
@@ -0,0 +1,159 @@
+// scoring_policies.hpp
+#pragma once
+
+#include "data_book.hpp"
+#include <array>
+#include <cstdint>
+
+// Scoring policies for ScoringEngine. A policy is a type with
+//   static constexpr DirtyLevels dependencies();     // book levels it reads
+//   static int64_t score(const DataBook& book);      // composite score * 1e9
+//   static int64_t score(const BookSnapshot& book);  // the same, from a copy
+// The engine is instantiated per policy, so the whole policy inlines into the
+// processing path. The snapshot form lets a ScoreSet read the book once for
+// several policies.
+namespace scoring {
+
+using LevelWeights = std::array<double, MAX_BOOK_LEVELS>;
+
+// Levels 0..n-1 of both sides
+constexpr DirtyLevels levels_below(int n) {
+    uint32_t side = (n >= 16 ? 0xFFFFu : (1u << n) - 1);
+    return DirtyLevels{side | (side << 16)};
+}
+
+// Weighted sums over one side of the book
+struct SideDepth {
+    double value_volume = 0.0;  // sum of w * volume * value (value scaled by 1e9)
+    double volume = 0.0;        // sum of w * volume
+};
+
+struct BookDepth {
+    SideDepth demand;
+    SideDepth supply;
+};
+
+// Kernel shared by the depth policies: one pass over all MAX_BOOK_LEVELS of
+// both sides with a fixed trip count and no branches. Levels a policy ignores
+// carry weight 0, so every policy runs the same straight-line loop, and the
+// two sides' products are computed side by side.
+inline BookDepth weighted_depth(const BookSnapshot& book, const LevelWeights& weights) {
+    std::array<double, MAX_BOOK_LEVELS> demand_wv, supply_wv, demand_wvv, supply_wvv;
+    for (int i = 0; i < MAX_BOOK_LEVELS; ++i) {
+        demand_wv[i] = weights[i] * book.demand_volumes[i];
+        supply_wv[i] = weights[i] * book.supply_volumes[i];
+        demand_wvv[i] = demand_wv[i] * static_cast<double>(book.demand_values[i]);
+        supply_wvv[i] = supply_wv[i] * static_cast<double>(book.supply_values[i]);
+    }
+    BookDepth depth;
+    for (int i = 0; i < MAX_BOOK_LEVELS; ++i) {
+        depth.demand.volume += demand_wv[i];
+        depth.supply.volume += supply_wv[i];
+        depth.demand.value_volume += demand_wvv[i];
+        depth.supply.value_volume += supply_wvv[i];
+    }
+    return depth;
+}
+
+// Midpoint of the two sides' weighted average values; a side with no volume
+// is left out, an empty book scores 0
+inline int64_t depth_midpoint(const BookDepth& depth) {
+    const SideDepth& d = depth.demand;
+    const SideDepth& s = depth.supply;
+    if (d.volume <= 0.0 && s.volume <= 0.0) return 0;
+    if (d.volume <= 0.0) return static_cast<int64_t>(s.value_volume / s.volume);
+    if (s.volume <= 0.0) return static_cast<int64_t>(d.value_volume / d.volume);
+    return static_cast<int64_t>((d.value_volume / d.volume + s.value_volume / s.volume) / 2.0);
+}
+
+// Level-0 volume-weighted midpoint: each side's value weighted by the other
+// side's volume. Integer arithmetic, so scores are bit-exact.
+struct TopOfBookMidpoint {
+    static constexpr DirtyLevels dependencies() { return levels_below(1); }
+
+    static int64_t score(const DataBook& book) {
+        // One consistent read of level 0; values are already scaled by 1e9
+        const TopOfBook top = book.topOfBook();
+        return midpoint(top.demand_value, top.demand_volume, top.supply_value, top.supply_volume);
+    }
+    static int64_t score(const BookSnapshot& book) {
+        return midpoint(book.demand_values[0], book.demand_volumes[0], book.supply_values[0], book.supply_volumes[0]);
+    }
+
+    // The formula itself, shared with the batched kernel (score_batch.hpp)
+    static int64_t midpoint(int64_t demand_val, int demand_vol, int64_t supply_val, int supply_vol) {
+        int total_vol = demand_vol + supply_vol;
+        if (total_vol == 0) {
+            if (demand_val > 0 && supply_val > 0)
+                return (demand_val + supply_val) / 2;
+            else
+                return 0;
+        }
+
+        int64_t weighted = (demand_val * supply_vol + supply_val * demand_vol) / total_vol;
+        return weighted;
+    }
+};
+
+// Level-0 volume imbalance (demand - supply) / (demand + supply), in [-1, 1]
+// scaled by 1e9; 0 when both sides are empty. Integer arithmetic.
+struct TopOfBookImbalance {
+    static constexpr DirtyLevels dependencies() { return levels_below(1); }
+
+    static int64_t score(const DataBook& book) {
+        const TopOfBook top = book.topOfBook();
+        return imbalance(top.demand_volume, top.supply_volume);
+    }
+    static int64_t score(const BookSnapshot& book) {
+        return imbalance(book.demand_volumes[0], book.supply_volumes[0]);
+    }
+
+    static int64_t imbalance(int64_t demand_vol, int64_t supply_vol) {
+        int64_t total_vol = demand_vol + supply_vol;
+        if (total_vol == 0) return 0;
+        return (demand_vol - supply_vol) * 1000000000LL / total_vol;
+    }
+};
+
+// N-level VWAP: midpoint of each side's volume-weighted average value over
+// levels 0..N-1
+template <int N>
+struct DepthVwap {
+    static_assert(N >= 1 && N <= MAX_BOOK_LEVELS, "N must be a book level count");
+    static constexpr DirtyLevels dependencies() { return levels_below(N); }
+
+    static constexpr LevelWeights weights() {
+        LevelWeights w{};
+        for (int i = 0; i < N; ++i) w[i] = 1.0;
+        return w;
+    }
+
+    static int64_t score(const DataBook& book) { return score(book.snapshot()); }
+    static int64_t score(const BookSnapshot& book) {
+        static constexpr LevelWeights W = weights();
+        return depth_midpoint(weighted_depth(book, W));
+    }
+};
+
+// Exponentially weighted depth: level i weighs (DecayPercent / 100)^i, so
+// deeper levels count for less
+template <int DecayPercent>
+struct ExpWeightedDepth {
+    static_assert(DecayPercent > 0 && DecayPercent <= 100, "decay is a percentage");
+    static constexpr DirtyLevels dependencies() { return levels_below(MAX_BOOK_LEVELS); }
+
+    static constexpr LevelWeights weights() {
+        LevelWeights w{};
+        double wi = 1.0;
+        for (int i = 0; i < MAX_BOOK_LEVELS; ++i, wi *= DecayPercent / 100.0) w[i] = wi;
+        return w;
+    }
+
+    static int64_t score(const DataBook& book) { return score(book.snapshot()); }
+    static int64_t score(const BookSnapshot& book) {
+        static constexpr LevelWeights W = weights();
+        return depth_midpoint(weighted_depth(book, W));
+    }
+};
+
+}  // namespace scoring
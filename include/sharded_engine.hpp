@@ -0,0 +1,154 @@
+// sharded_engine.hpp
+#pragma once
+
+#include "parser_utils.hpp"
+#include "pipeline.hpp"
+#include "sharded_ingest.hpp"
+#include "spsc_ring.hpp"
+#include "tcp_sender.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+struct WorkerStats {
+    uint64_t messages = 0;          // messages routed to this worker
+    size_t inbox_max_depth = 0;
+    uint64_t dispatch_stalls = 0;   // messages the dispatcher had to wait to queue
+    uint64_t oversized = 0;         // messages dropped as larger than an inbox record
+    size_t egress_max_depth = 0;
+    uint64_t egress_stalls = 0;     // records this worker had to wait to queue
+};
+
+// Subject-partitioned processing on N worker threads. One dispatcher, the
+// receive thread, validates each datagram and copies every message into the
+// inbox of the worker that owns its subject_id. A worker owns its subjects'
+// books and last-sent state (its own DataBookManager) and queues its records
+// in its own EgressQueue; one egress thread drains those into the TcpSender.
+// Inboxes and output queues are SpscRings, so no lock is taken between the
+// dispatcher and the egress thread and no state is shared between workers.
+// Only the egress thread writes to the TcpSender, so its mutex is uncontended.
+//
+// A subject always maps to the same worker and every ring is FIFO, so the
+// records of one subject leave in the order its messages arrived. Records of
+// different subjects may interleave differently than with one thread. A full
+// inbox makes the dispatcher wait; the socket buffer absorbs the backlog.
+//
+// Idle workers, the egress thread and a dispatcher waiting for inbox room
+// spin briefly, then park on an IdleWaiter until the other side publishes or
+// drains, so an idle engine does not hold N + 1 cores. Workers also wake
+// every setIdleWake() interval so batch_end() runs on time; setSpin() keeps
+// every thread polling instead.
+class ShardedEngine {
+public:
+    static constexpr size_t INBOX_CAPACITY = 1024;
+
+    ShardedEngine(TcpSender& sender, size_t num_workers);
+    ~ShardedEngine();
+
+    size_t numWorkers() const { return workers_.size(); }
+    // Same partitioning as ShardedIngest
+    static size_t workerFor(uint32_t subject_id, size_t num_workers) {
+        return ShardedIngest::shardFor(subject_id, num_workers);
+    }
+
+    // Before start(): longest an idle worker parks (0 = until a message or
+    // stop()), and whether idle threads poll instead
+    void setIdleWake(uint64_t ns) { idle_wake_ns_ = ns; }
+    void setSpin(bool enabled);
+
+    // Starts the egress thread and the workers. Worker w calls
+    // handler(w, msg, egress) for each of its messages, batch_end(w, egress)
+    // whenever its inbox has been drained and again on every idle pass and idle wake, and
+    // finish(w, egress) once its inbox is empty after stop(). msg is a
+    // PacketView into the inbox, valid for the duration of the call.
+    template <typename Handler, typename BatchEnd, typename Finish>
+    void start(Handler handler, BatchEnd batch_end, Finish finish);
+
+    // Dispatcher: routes every message of the datagram, all stamped with
+    // kernel_rx_ns. False, with nothing routed, if the datagram is malformed.
+    // A message that does not fit an inbox record is dropped and counted.
+    bool dispatch(const uint8_t* data, size_t length, uint64_t kernel_rx_ns);
+
+    // No more dispatch(); the workers drain their inboxes and finish, then the
+    // egress thread drains their output queues
+    void stop();
+
+    WorkerStats stats(size_t worker) const;
+
+private:
+    struct Worker {
+        std::unique_ptr<SpscRing<DatagramRecord, INBOX_CAPACITY>> inbox;   // one message per record
+        std::unique_ptr<EgressQueue> egress;
+        std::thread thread;
+        IdleWaiter waiter;   // the worker, parked on an empty inbox
+
+        // Written by the dispatcher, read by stats()
+        std::atomic<uint64_t> messages{0};
+        std::atomic<uint64_t> dispatch_stalls{0};
+        std::atomic<uint64_t> oversized{0};
+        // Written by the worker at the start of each drain pass
+        std::atomic<size_t> inbox_max_depth{0};
+    };
+
+    template <typename Handler, typename BatchEnd>
+    void workerLoop(size_t index, Handler& handler, BatchEnd& batch_end);
+
+    TcpSender& sender_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    IdleWaiter egress_waiter_;   // the egress thread, parked on empty output queues
+    IdleWaiter dispatch_room_;   // the dispatcher, parked on a full inbox
+    std::thread egress_thread_;
+    std::atomic<bool> dispatch_done_{false};
+    std::atomic<bool> egress_done_{false};
+    bool started_ = false;
+    uint64_t idle_wake_ns_ = 0;
+};
+
+template <typename Handler, typename BatchEnd, typename Finish>
+void ShardedEngine::start(Handler handler, BatchEnd batch_end, Finish finish) {
+    if (started_) return;
+    started_ = true;
+    dispatch_done_ = false;
+    egress_done_ = false;
+
+    egress_thread_ = std::thread([this] {
+        std::vector<EgressQueue*> queues;
+        for (auto& w : workers_) queues.push_back(w->egress.get());
+        run_egress(queues.data(), queues.size(), sender_, egress_done_, egress_waiter_);
+    });
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        workers_[i]->thread = std::thread([this, i, handler, batch_end, finish]() mutable {
+            workerLoop(i, handler, batch_end);
+            finish(i, *workers_[i]->egress);
+        });
+    }
+}
+
+template <typename Handler, typename BatchEnd>
+void ShardedEngine::workerLoop(size_t index, Handler& handler, BatchEnd& batch_end) {
+    Worker& self = *workers_[index];
+    for (;;) {
+        bool drained_any = false;
+        while (const DatagramRecord* rec = self.inbox->front()) {
+            if (!drained_any) raise_max_depth(self.inbox_max_depth, self.inbox->consumerDepth());
+            PacketView msg;
+            (void)parse_packet_view(rec->data, rec->length, msg);   // validated by dispatch()
+            msg.t_kernel_rx = rec->kernel_rx_ns;
+            handler(index, static_cast<const PacketView&>(msg), *self.egress);
+            self.inbox->pop();
+            drained_any = true;
+        }
+        if (drained_any) dispatch_room_.notify();
+        batch_end(index, *self.egress);
+        if (drained_any) {
+            self.waiter.busy();
+            continue;
+        }
+        if (dispatch_done_.load(std::memory_order_acquire) && self.inbox->size() == 0) break;
+        self.waiter.idle(
+            [&] { return self.inbox->size() > 0 || dispatch_done_.load(std::memory_order_acquire); }, idle_wake_ns_);
+    }
+}
@@ -0,0 +1,79 @@
+// sharded_ingest.hpp
+#pragma once
+
+#include "types.hpp"
+#include "udp_receiver.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ShardStats {
+    uint64_t datagrams = 0;   // datagrams read from this shard's socket
+    uint64_t processed = 0;   // messages handled by this shard's worker
+    uint64_t rerouted = 0;    // messages this shard's socket passed to another worker
+};
+
+// SO_REUSEPORT sharded ingest: N sockets on the same port, each drained by its
+// own receive thread, and N workers that each own a disjoint set of subjects.
+// Every message is routed to the worker owning its subject_id, so a DataBook is
+// only ever touched by one thread.
+//
+// For unicast feeds the kernel spreads flows across the sockets, so messages are
+// re-routed between shards. For multicast every socket receives a copy of every
+// datagram; each socket then keeps only the subjects its own worker owns.
+class ShardedIngest {
+public:
+    // Runs on worker `shard` for every message that shard owns
+    using MessageHandler = std::function<void(size_t shard, const ProcessedMessage& msg)>;
+
+    ShardedIngest(const std::string& mcast_ip,
+                  uint16_t mcast_port,
+                  const std::string& interface_name,
+                  size_t num_shards,
+                  size_t batch_size = UdpReceiver::DEFAULT_BATCH_SIZE);
+    ~ShardedIngest();
+
+    bool start(MessageHandler handler);
+    void stop();
+
+    size_t numShards() const { return shards_.size(); }
+    ShardStats stats(size_t shard) const;
+
+    // Multiplicative hash reduced by its high bits: the product's low bits are
+    // only subject_id mod 2^k, so taking them mod a power-of-two shard count
+    // would undo the hash
+    static size_t shardFor(uint32_t subject_id, size_t num_shards) {
+        const uint64_t h = static_cast<uint32_t>(subject_id * 2654435761u);
+        return static_cast<size_t>((h * num_shards) >> 32);
+    }
+
+private:
+    struct Shard {
+        std::unique_ptr<UdpReceiver> receiver;
+        std::thread recv_thread;
+        std::thread worker_thread;
+
+        // Inbox filled by any receive thread, drained by this shard's worker
+        std::mutex inbox_mtx;
+        std::condition_variable inbox_cv;
+        std::vector<ProcessedMessage> inbox;
+        bool stopping = false;
+
+        uint64_t processed = 0;
+        uint64_t rerouted = 0;
+    };
+
+    void receiveLoop(size_t index);
+    void workerLoop(size_t index);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    MessageHandler handler_;
+    size_t batch_size_;
+    bool multicast_ = false;
+    bool started_ = false;
+};
@@ -0,0 +1,63 @@
+// spsc_ring.hpp
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded single-producer single-consumer ring of fixed-size records. The
+// producer's and the consumer's indices sit on their own cache lines, each
+// next to a cached copy of the other side's index, so a push or pop touches
+// the shared line only when the cached copy says the ring looks full or
+// empty. Records are written and read in place: claim() / publish() on the
+// producer thread, front() / pop() on the consumer thread. Never allocates
+// after construction; hold it by pointer, the slots are stored inline.
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    static constexpr size_t CAPACITY = Capacity;
+
+    // Producer: slot for the next record, or nullptr if the ring is full
+    T* claim() {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_cache_ == Capacity) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head - tail_cache_ == Capacity) return nullptr;
+        }
+        return &slots_[head & (Capacity - 1)];
+    }
+    // Producer: makes the claimed record visible to the consumer
+    void publish() { head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Consumer: oldest record, or nullptr if the ring is empty
+    const T* front() {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_cache_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail == head_cache_) return nullptr;
+        }
+        return &slots_[tail & (Capacity - 1)];
+    }
+    // Consumer: releases the record returned by front()
+    void pop() { tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Consumer: records published as of its last look at the producer's index,
+    // without touching the producer's line. Right after front() has had to
+    // reload that index it is the exact depth, so sampling it at the start of
+    // each drain pass sees every backlog the consumer has caught up with.
+    size_t consumerDepth() const { return head_cache_ - tail_.load(std::memory_order_relaxed); }
+
+    // Records queued; exact on either side's thread, a snapshot elsewhere
+    size_t size() const {
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        return head_.load(std::memory_order_acquire) - tail;
+    }
+
+private:
+    alignas(64) std::atomic<size_t> head_{0};   // next slot the producer writes
+    size_t tail_cache_ = 0;
+    alignas(64) std::atomic<size_t> tail_{0};   // next slot the consumer reads
+    size_t head_cache_ = 0;
+    alignas(64) T slots_[Capacity];
+};
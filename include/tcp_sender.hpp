@@ -6,6 +6,9 @@
 #include <vector>
 #include <cstdint>
 #include "types.hpp"
+
+class IoUringEngine;
+
 struct TcpSendRecord {
     uint32_t subject_id;
     int64_t scaled_composite_score;
@@ -20,20 +23,59 @@ public:
 
     bool connect();
     void close();
+    // Writes the send log, oldest record first
     void dumpSendLog(const std::string& filename);
+    // The send log keeps the latest records only, in storage allocated by the
+    // first sender, so logging a send never allocates
+    static constexpr size_t SEND_LOG_CAPACITY = 1 << 16;
 
     void sendIfChanged(const CompositeScoreMessage& msg, uint64_t* send_timestamp_ns = nullptr); // optional legacy
     void send(const CompositeScoreMessage& msg, uint64_t* send_timestamp_ns = nullptr);           // new raw sender
+    // One record of count values: subject_id then each value, host byte order.
+    // With count == 1 this is exactly what send() writes.
+    void sendScores(uint32_t subject_id, const int64_t* scores, size_t count, uint64_t* send_timestamp_ns = nullptr);
+    static constexpr size_t MAX_RECORD_VALUES = MAX_SCORE_OUTPUTS + 4;   // scores + ScoreAnalytics fields
+
+    // Write combining for one egress thread: queueScores() frames a record as
+    // sendScores() would into a pending buffer, flush() writes the buffer in
+    // one send(). A full buffer is flushed first. Not for an io_uring engine.
+    void queueScores(uint32_t subject_id, const int64_t* scores, size_t count);
+    void flush();
+    static constexpr size_t COMBINE_BYTES = 64 * 1024;
+
+    // Appends one row to the latency trace (append_latency_sample)
+    void logLatency(const LatencySample& sample);
+
+    // When set, each record carries the subject's ScoreAnalytics after its scores
+    void setRecordAnalytics(bool enabled) { record_analytics_ = enabled; }
+    bool recordAnalytics() const { return record_analytics_; }
     bool hasScoreChanged(uint32_t subject_id, int64_t new_score) const;                          // new checker
+    // last_sent_ only tracks sendIfChanged(); the hot path keeps its last sent
+    // score in the SubjectRecord instead
+
+    // Queue sends on an io_uring engine instead of blocking in ::send(); send()
+    // must then be called from the thread running the engine
+    void attachEngine(IoUringEngine* engine) { engine_ = engine; }
+    int fd() const { return sockfd_; }
 
 private:
     std::string host_;
     uint16_t port_;
     int sockfd_ = -1;
+    IoUringEngine* engine_ = nullptr;
+    bool record_analytics_ = false;
 
     mutable std::mutex mtx_;
     std::unordered_map<uint32_t, int64_t> last_sent_;
 
-    static std::vector<TcpSendRecord> send_log;
+    // queueScores() records not yet written, and their send_log entries
+    std::vector<uint8_t> pending_;
+    std::vector<TcpSendRecord> pending_log_;
+
+    // Caller holds log_mtx
+    static void logSend(const TcpSendRecord& record);
+
+    static std::vector<TcpSendRecord> send_log;   // ring of SEND_LOG_CAPACITY records
+    static uint64_t send_log_count;               // records ever logged
     static std::mutex log_mtx;
 };
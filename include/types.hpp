@@ -8,6 +8,7 @@
 
 extern bool g_enable_latency_logging;
 constexpr int MAX_BOOK_LEVELS = 10;
+constexpr int MAX_SCORE_OUTPUTS = 4;   // scores per output record (--score a,b,...)
 
 // one level of data book update
 struct DataLevel {
@@ -21,6 +22,7 @@ struct DataLevel {
 struct [[nodiscard]] ProcessedMessage {
     uint32_t subject_id;
     std::vector<DataLevel> updates;
+    uint64_t t_kernel_rx = 0; // kernel arrival time of the carrying datagram (now_ns() clock), 0 if unknown
 };
 
 // Op to TCP
@@ -30,6 +32,7 @@ struct [[nodiscard]] CompositeScoreMessage {
 };
 struct LatencySample {
     uint32_t subject_id;
+    int64_t t_kernel_rx; // socket arrival (SO_TIMESTAMPNS), 0 if unavailable
     int64_t t_recv;
     int64_t t_parsed;
     int64_t t_calc_start;
@@ -3,24 +3,145 @@
 
 #include <string>
 #include <cstdint>
+#include <cstddef>
+#include <atomic>
 #include <functional>
+#include <memory>
+#include <utility>
+#include <sys/socket.h>
+
+class IoUringEngine;
+
+// One datagram of a recvmmsg() batch; data points into the receiver's buffers
+// and is only valid for the duration of the batch callback.
+struct UdpDatagram {
+    const uint8_t* data;
+    size_t length;
+    uint64_t kernel_rx_ns;   // SO_TIMESTAMPNS arrival time on the now_ns() clock, 0 if unavailable
+};
+
+// Receive-side counters, updated by the receive thread only
+struct UdpReceiverStats {
+    uint64_t syscalls = 0;     // recv()/recvmmsg() calls that returned data
+    uint64_t datagrams = 0;    // datagrams handed to the callback
+    uint64_t empty_polls = 0;  // spin mode: non-blocking calls that found nothing
+};
+
+// Low-latency receive options, applied by the receive loop to its own thread
+struct ReceiveTuning {
+    bool spin = false;         // non-blocking socket polled in a tight loop instead of sleeping in recv()
+    int busy_poll_us = 50;     // SO_BUSY_POLL budget in spin mode (0 = leave unset)
+    int cpu = -1;              // pin the receive thread to this CPU (-1 = no pinning)
+    bool sched_fifo = false;   // run the receive thread as SCHED_FIFO
+    int idle_wake_us = 0;      // blocking mode: give up waiting in recvmmsg() after this long (0 = never)
+};
 
 class UdpReceiver {
 public:
     using PacketCallback = std::function<void(const uint8_t* data, size_t length)>;
+    using TimedPacketCallback = std::function<void(const uint8_t* data, size_t length, uint64_t kernel_rx_ns)>;
+    using BatchCallback = std::function<void(const UdpDatagram* batch, size_t count)>;
+
+    static constexpr size_t MAX_DATAGRAM_SIZE = 2048;
+    static constexpr size_t DEFAULT_BATCH_SIZE = 64;
 
     UdpReceiver(const std::string& mcast_ip,
                 uint16_t mcast_port,
                 const std::string& interface_name);
+    ~UdpReceiver();
 
+    // Single-packet loop: one recvmsg() and one callback per datagram
     bool start(PacketCallback callback);
+    bool start(TimedPacketCallback callback);
+
+    // Batched loop: up to batch_size datagrams per recvmmsg() into preallocated
+    // buffers, delivered to the callback as one batch
+    bool startBatch(BatchCallback callback, size_t batch_size = DEFAULT_BATCH_SIZE);
+
+    // Same batched loop with the handler as a template parameter, so the call
+    // per datagram is direct and the handler can be inlined into the loop.
+    // Handler is invoked as handler(const uint8_t* data, size_t length, uint64_t kernel_rx_ns).
+    template <typename Handler>
+    bool run(Handler&& handler, size_t batch_size = DEFAULT_BATCH_SIZE);
+    // As run(), and calls batch_end() once every datagram of a recvmmsg()
+    // batch has been handed to handler, and whenever a receive comes back
+    // empty (a spin poll, or an idle wake)
+    template <typename Handler, typename BatchEnd>
+    bool runBatched(Handler&& handler, BatchEnd&& batch_end, size_t batch_size = DEFAULT_BATCH_SIZE);
+
+    // io_uring loop: multishot recv driven by engine on the calling thread, which
+    // also carries any egress queued on the engine from inside the callback.
+    // Multishot recv carries no control messages, so no kernel timestamps here.
+    bool startUring(PacketCallback callback, IoUringEngine& engine);
+
     void stop();
 
+    // For callers multiplexing several sockets on one thread: open() binds and
+    // allocates batch buffers without entering a loop, and pollBatch() does one
+    // non-blocking recvmmsg() when fd() is readable. Returns datagrams delivered.
+    bool open(size_t batch_size = DEFAULT_BATCH_SIZE);
+    int fd() const { return sockfd_; }
+    size_t pollBatch(const BatchCallback& callback);
+
+    // SO_REUSEPORT lets several receivers bind the same port (one per shard).
+    // Must be set before start().
+    void setReusePort(bool enable) { reuse_port_ = enable; }
+    // Spin/pinning options; must be set before start()
+    void setTuning(const ReceiveTuning& tuning) { tuning_ = tuning; }
+    bool isMulticast() const;
+    // Pins/raises the calling thread as the tuning asks; the receive loops
+    // call it themselves, callers multiplexing with pollBatch() call it once
+    void applyThreadTuning();
+
+    const UdpReceiverStats& stats() const { return stats_; }
+
 private:
+    struct BatchBuffers;
+
+    bool openSocket();
+    // One recvmmsg() into batch_; the datagrams are left in received_
+    int receiveBatch(int flags);
+    int receiveBatch(int flags, const BatchCallback& callback);
+
     int sockfd_ = -1;
-    bool running_ = false;
+    std::atomic<bool> running_{false};
+    bool reuse_port_ = false;
+    ReceiveTuning tuning_;
+    std::atomic<IoUringEngine*> engine_{nullptr};
+    UdpReceiverStats stats_;
+    std::unique_ptr<BatchBuffers> batch_;
+    const UdpDatagram* received_ = nullptr;
 
     std::string mcast_ip_;
     uint16_t mcast_port_;
     std::string interface_name_;
 };
+
+template <typename Handler>
+bool UdpReceiver::run(Handler&& handler, size_t batch_size) {
+    return runBatched(std::forward<Handler>(handler), [] {}, batch_size);
+}
+
+template <typename Handler, typename BatchEnd>
+bool UdpReceiver::runBatched(Handler&& handler, BatchEnd&& batch_end, size_t batch_size) {
+    if (!open(batch_size)) return false;
+
+    const int flags = tuning_.spin ? MSG_DONTWAIT : MSG_WAITFORONE;
+
+    applyThreadTuning();
+    running_ = true;
+    while (running_) {
+        int n = receiveBatch(flags);
+        if (n <= 0) {
+            if (tuning_.spin) ++stats_.empty_polls;
+            batch_end();
+            continue;
+        }
+        for (int i = 0; i < n; ++i) {
+            handler(received_[i].data, received_[i].length, received_[i].kernel_rx_ns);
+        }
+        batch_end();
+    }
+
+    return true;
+}
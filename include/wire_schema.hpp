@@ -0,0 +1,150 @@
+// wire_schema.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#endif
+
+// The Source Endpoint wire format, described once. A message is a header
+// followed by update_count level records; every integer is big-endian.
+// Parser, level decoder, generators, benchmarks and the multithread/ services
+// all encode and decode through these fields, so each field is one load or
+// store at a fixed offset plus a byte swap, and no two components can disagree.
+// Depends on nothing but the standard library so multithread/ can share it.
+namespace wire {
+
+template <typename U>
+inline U byteswap(U v) {
+    static_assert(std::is_unsigned<U>::value, "byteswap on raw unsigned bits");
+    if constexpr (sizeof(U) == 1) {
+        return v;
+    } else if constexpr (sizeof(U) == 2) {
+#if defined(_MSC_VER)
+        return _byteswap_ushort(v);
+#else
+        return __builtin_bswap16(v);
+#endif
+    } else if constexpr (sizeof(U) == 4) {
+#if defined(_MSC_VER)
+        return _byteswap_ulong(v);
+#else
+        return __builtin_bswap32(v);
+#endif
+    } else {
+        static_assert(sizeof(U) == 8, "unsupported field width");
+#if defined(_MSC_VER)
+        return _byteswap_uint64(v);
+#else
+        return __builtin_bswap64(v);
+#endif
+    }
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+template <typename U> inline U to_host(U v) { return v; }
+#else
+template <typename U> inline U to_host(U v) { return byteswap(v); }
+#endif
+
+// One integer field at a fixed byte offset within its record
+template <typename T, size_t Offset>
+struct Field {
+    static_assert(std::is_integral<T>::value, "wire fields are integers");
+    using type = T;
+    using raw_type = std::make_unsigned_t<T>;
+    static constexpr size_t offset = Offset;
+    static constexpr size_t size = sizeof(T);
+    static constexpr size_t end = Offset + sizeof(T);
+
+    static T load(const uint8_t* record) {
+        raw_type raw;
+        std::memcpy(&raw, record + Offset, sizeof(raw));
+        return static_cast<T>(to_host(raw));
+    }
+    static void store(uint8_t* record, T v) {
+        raw_type raw = to_host(static_cast<raw_type>(v));
+        std::memcpy(record + Offset, &raw, sizeof(raw));
+    }
+};
+
+// True if the fields follow each other with no gap or overlap, starting at 0
+template <typename... Fields>
+constexpr bool is_packed() {
+    size_t next = 0;
+    bool packed = true;
+    ((packed = packed && Fields::offset == next, next = Fields::end), ...);
+    return packed;
+}
+
+template <typename... Fields>
+struct Record {
+    static_assert(is_packed<Fields...>(), "wire record fields must be contiguous");
+    static constexpr size_t SIZE = (Fields::size + ... + 0);
+};
+
+struct MessageHeader {
+    using MsgLen = Field<uint32_t, 0>;      // bytes after this field
+    using SubjectId = Field<uint32_t, 4>;
+    using UpdateCount = Field<uint16_t, 8>;
+    static constexpr size_t SIZE = Record<MsgLen, SubjectId, UpdateCount>::SIZE;
+};
+
+struct LevelRecord {
+    using Level = Field<uint8_t, 0>;        // 0-9
+    using Side = Field<uint8_t, 1>;         // 0 = demand, 1 = supply
+    using Value = Field<int64_t, 2>;        // scaled value (value * 10^9)
+    using Volume = Field<uint32_t, 10>;
+    static constexpr size_t SIZE = Record<Level, Side, Value, Volume>::SIZE;
+};
+
+static_assert(MessageHeader::SIZE == 10, "header layout changed");
+static_assert(LevelRecord::SIZE == 14, "level record layout changed");
+
+constexpr size_t message_size(size_t update_count) {
+    return MessageHeader::SIZE + update_count * LevelRecord::SIZE;
+}
+
+// msg_len of a message with update_count records
+constexpr uint32_t msg_len_for(size_t update_count) {
+    return static_cast<uint32_t>(message_size(update_count) - MessageHeader::MsgLen::end);
+}
+
+// Level codecs work on any struct with level, side, value and volume members
+// (DataLevel in the engine, the generators' own update structs)
+template <typename L>
+inline void decode_level(const uint8_t* record, L& out) {
+    out.level = LevelRecord::Level::load(record);
+    out.side = LevelRecord::Side::load(record);
+    out.value = LevelRecord::Value::load(record);
+    out.volume = LevelRecord::Volume::load(record);
+}
+
+template <typename L>
+inline void encode_level(uint8_t* record, const L& lvl) {
+    LevelRecord::Level::store(record, lvl.level);
+    LevelRecord::Side::store(record, lvl.side);
+    LevelRecord::Value::store(record, lvl.value);
+    LevelRecord::Volume::store(record, lvl.volume);
+}
+
+inline void encode_header(uint8_t* out, uint32_t subject_id, uint16_t update_count) {
+    MessageHeader::MsgLen::store(out, msg_len_for(update_count));
+    MessageHeader::SubjectId::store(out, subject_id);
+    MessageHeader::UpdateCount::store(out, update_count);
+}
+
+// Writes one complete message into out, which must hold message_size(count)
+// bytes. Returns the bytes written.
+template <typename L>
+inline size_t encode_message(uint8_t* out, uint32_t subject_id, const L* levels, uint16_t count) {
+    encode_header(out, subject_id, count);
+    uint8_t* p = out + MessageHeader::SIZE;
+    for (uint16_t i = 0; i < count; ++i, p += LevelRecord::SIZE) encode_level(p, levels[i]);
+    return message_size(count);
+}
+
+}  // namespace wire
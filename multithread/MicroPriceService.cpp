@@ -10,6 +10,7 @@
 #include <cstring>
 #include <fstream>
 #include <filesystem>
+#include "wire_schema.hpp"
 
 
 using boost::asio::ip::udp;
@@ -50,29 +51,24 @@ std::condition_variable queue_cv;
 bool running = true;
 
 void parse_and_update(const std::vector<uint8_t>& data) {
-    if (data.size() < 10) return;
+    using Header = wire::MessageHeader;
+    using Level = wire::LevelRecord;
+    if (data.size() < Header::SIZE) return;
 
-    size_t offset = 0;
-    uint32_t msg_length;
-    std::memcpy(&msg_length, &data[offset], 4); offset += 4;
-    uint32_t subject_id;
-    std::memcpy(&subject_id, &data[offset], 4); offset += 4;
-    uint16_t num_updates;
-    std::memcpy(&num_updates, &data[offset], 2); offset += 2;
+    uint32_t subject_id = Header::SubjectId::load(data.data());
+    uint16_t num_updates = Header::UpdateCount::load(data.data());
+    if (wire::message_size(num_updates) > data.size()) return;
 
     {
         std::lock_guard<std::mutex> lock(data_mutex);
         DataBook& db = data_books[subject_id];
 
-        for (int i = 0; i < num_updates; ++i) {
-            if (offset + 14 > data.size()) break;
-
-            uint8_t level = data[offset]; offset += 1;
-            uint8_t side = data[offset]; offset += 1;
-            int64_t scaled_value;
-            std::memcpy(&scaled_value, &data[offset], 8); offset += 8;
-            uint32_t volume;
-            std::memcpy(&volume, &data[offset], 4); offset += 4;
+        const uint8_t* record = data.data() + Header::SIZE;
+        for (int i = 0; i < num_updates; ++i, record += Level::SIZE) {
+            uint8_t level = Level::Level::load(record);
+            uint8_t side = Level::Side::load(record);
+            int64_t scaled_value = Level::Value::load(record);
+            uint32_t volume = Level::Volume::load(record);
 
             double value = static_cast<double>(scaled_value) / 1e9;
             if (level >= DATA_BOOK_LEVELS) continue;
@@ -424,6 +424,7 @@ echo "Adding supplementary files..."
 cp CMakeLists.txt $DIST_DIR/
 cp *.cpp $DIST_DIR/ 2>/dev/null || true
 cp *.h $DIST_DIR/ 2>/dev/null || true
+cp ../include/wire_schema.hpp $DIST_DIR/
 
 # Create the distribution archive
 echo "Creating distribution archive..."
@@ -0,0 +1,49 @@
+#!/bin/bash
+# Runs the integration test once per receive mode and compares the resulting
+# latency traces. Expects binaries from run_full_pipeline.sh (build/bin) and
+# test vectors in test_data/.
+set -o errexit
+set -o nounset
+set -o pipefail
+
+# ======= CONFIGURATION =======
+TCP_PORT=6010
+LOG_DIR=logs
+MCAST_IP="239.0.0.1"
+MCAST_PORT=5000
+INTERFACE="eth0"
+TCP_HOST="127.0.0.1"
+SPIN_CPU=${SPIN_CPU:-1}
+# ==============================
+
+declare -A MODES=(
+    [blocking]=""
+    [spin]="--spin --cpu ${SPIN_CPU}"
+)
+
+mkdir -p $LOG_DIR test_results
+COMPARE_ARGS=()
+
+for mode in blocking spin; do
+    echo "========== Receive mode: $mode =========="
+    rm -f test_results/latency_trace.csv
+
+    setsid ./build/bin/tcp_receiver $TCP_PORT \
+      > $LOG_DIR/tcp_stdout_$mode.log \
+      2> $LOG_DIR/tcp_stderr_$mode.log &
+    TCP_PID=$!
+    sleep 0.2
+
+    # shellcheck disable=SC2086
+    ./build/bin/test_all "$MCAST_IP" "$MCAST_PORT" "$INTERFACE" "$TCP_HOST" "$TCP_PORT" ${MODES[$mode]} \
+      2>&1 | tee test_results/test_all_$mode.log
+
+    kill $TCP_PID 2>/dev/null || true
+    wait $TCP_PID 2>/dev/null || true
+
+    mv test_results/latency_trace.csv test_results/latency_trace_$mode.csv
+    COMPARE_ARGS+=("$mode=test_results/latency_trace_$mode.csv")
+done
+
+echo "========== Latency comparison (microseconds) =========="
+python3 test/compare_latency.py "${COMPARE_ARGS[@]}"
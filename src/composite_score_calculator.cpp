@@ -1,21 +1,53 @@
 // composite_score_calculator.cpp
 #include "composite_score_calculator.hpp"
-#include <limits>
-
-int64_t CompositeScoreCalculator::calculateCompositeScore(const DataBook& book) {
-    int64_t demand_val = static_cast<int64_t>(book.demandValue(0) * 1e9);
-    int64_t supply_val = static_cast<int64_t>(book.supplyValue(0) * 1e9);
-    int demand_vol = book.demandVolume(0);
-    int supply_vol = book.supplyVolume(0);
-
-    int total_vol = demand_vol + supply_vol;
-    if (total_vol == 0) {
-        if (demand_val > 0 && supply_val > 0)
-            return (demand_val + supply_val) / 2;
-        else
-            return 0;
-    }
 
-    int64_t weighted = (demand_val * supply_vol + supply_val * demand_vol) / total_vol;
-    return weighted;
+namespace {
+
+template <typename Policy>
+int64_t score_with(const DataBook& book) {
+    return ScoringEngine<Policy>().calculateCompositeScore(book);
+}
+
+template <typename Policy>
+int64_t score_snapshot_with(const BookSnapshot& book) {
+    return Policy::score(book);
+}
+
+template <typename Policy>
+constexpr ScorerInfo entry(const char* name, const char* description) {
+    return ScorerInfo{name, description, &score_with<Policy>, &score_snapshot_with<Policy>,
+                      Policy::dependencies(), ScoringEngine<Policy>::isTopOfBookMidpoint()};
+}
+
+const ScorerInfo REGISTRY[] = {
+    entry<scoring::TopOfBookMidpoint>("top", "level-0 volume-weighted midpoint (default)"),
+    entry<scoring::DepthVwap<3>>("vwap3", "midpoint of each side's VWAP over levels 0-2"),
+    entry<scoring::DepthVwap<5>>("vwap5", "midpoint of each side's VWAP over levels 0-4"),
+    entry<scoring::DepthVwap<MAX_BOOK_LEVELS>>("vwap10", "midpoint of each side's VWAP over all levels"),
+    entry<scoring::ExpWeightedDepth<50>>("exp50", "all levels, level i weighted 0.5^i"),
+    entry<scoring::ExpWeightedDepth<80>>("exp80", "all levels, level i weighted 0.8^i"),
+    entry<scoring::TopOfBookImbalance>("imbalance", "level-0 (demand - supply) / (demand + supply) volume"),
+    {nullptr, nullptr, nullptr, nullptr, DirtyLevels{}, false},
+};
+
+}  // namespace
+
+RegisteredScorer::RegisteredScorer() : info_(&REGISTRY[0]) {}
+
+bool ScoreSet::add(const ScorerInfo& info) {
+    if (count_ == MAX_SCORE_OUTPUTS) return false;
+    infos_[count_++] = &info;
+    dependencies_.bits |= info.dependencies.bits;
+    return true;
+}
+
+const ScorerInfo* scorer_registry() {
+    return REGISTRY;
+}
+
+const ScorerInfo* find_scorer(const std::string& name) {
+    for (const ScorerInfo* s = REGISTRY; s->name; ++s) {
+        if (name == s->name) return s;
+    }
+    return nullptr;
 }
@@ -2,51 +2,91 @@
 #include "data_book.hpp"
 #include <algorithm>
 
-DataBook::DataBook() {
-    demand_values_.fill(0);
-    demand_volumes_.fill(0);
-    supply_values_.fill(0);
-    supply_volumes_.fill(0);
+namespace {
+constexpr auto relaxed = std::memory_order_relaxed;
 }
 
+static_assert(sizeof(DataBook) == 6 * 64, "seq + level 0 in one line, levels 1-9 in five more");
+
 void DataBook::applyUpdate(const DataLevel& update) {
     if (update.level >= MAX_BOOK_LEVELS) return;
-    std::lock_guard<std::mutex> lock(mtx_);
-
-    if (update.side == 0) {
-        demand_values_[update.level] = update.value;
-        demand_volumes_[update.level] = update.volume;
-    } else {
-        supply_values_[update.level] = update.value;
-        supply_volumes_[update.level] = update.volume;
-    }
+    FixedLevel& lvl = slot(update);
+
+    uint32_t seq;
+    beginWrite(seq);
+    lvl.value.store(update.value, relaxed);
+    lvl.volume.store(static_cast<int32_t>(update.volume), relaxed);
+    endWrite(seq);
 }
 
-double DataBook::demandValue(int level) const {
-    if (level >= MAX_BOOK_LEVELS) return 0.0;
-    std::lock_guard<std::mutex> lock(mtx_);
-    return static_cast<double>(demand_values_[level]) / 1e9;
+BookSnapshot DataBook::snapshot() const {
+    BookSnapshot snap;
+    readConsistent([&] {
+        for (int i = 0; i < MAX_BOOK_LEVELS; ++i) {
+            snap.demand_values[i] = levels_[i].sides[0].value.load(relaxed);
+            snap.demand_volumes[i] = levels_[i].sides[0].volume.load(relaxed);
+            snap.supply_values[i] = levels_[i].sides[1].value.load(relaxed);
+            snap.supply_volumes[i] = levels_[i].sides[1].volume.load(relaxed);
+        }
+    });
+    return snap;
 }
 
-int DataBook::demandVolume(int level) const {
+int64_t DataBook::demandValueScaled(int level) const {
     if (level >= MAX_BOOK_LEVELS) return 0;
-    std::lock_guard<std::mutex> lock(mtx_);
-    return demand_volumes_[level];
+    return levels_[level].sides[0].value.load(relaxed);
 }
 
-double DataBook::supplyValue(int level) const {
-    if (level >= MAX_BOOK_LEVELS) return 0.0;
-    std::lock_guard<std::mutex> lock(mtx_);
-    return static_cast<double>(supply_values_[level]) / 1e9;
+int64_t DataBook::supplyValueScaled(int level) const {
+    if (level >= MAX_BOOK_LEVELS) return 0;
+    return levels_[level].sides[1].value.load(relaxed);
+}
+
+int DataBook::demandVolume(int level) const {
+    if (level >= MAX_BOOK_LEVELS) return 0;
+    return levels_[level].sides[0].volume.load(relaxed);
 }
 
 int DataBook::supplyVolume(int level) const {
     if (level >= MAX_BOOK_LEVELS) return 0;
-    std::lock_guard<std::mutex> lock(mtx_);
-    return supply_volumes_[level];
+    return levels_[level].sides[1].volume.load(relaxed);
 }
 
-DataBook& DataBookManager::getOrCreateBook(uint32_t subject_id) {
-    std::lock_guard<std::mutex> lock(books_mtx_);
-    return books_[subject_id];
+DataBookManager::DataBookManager(uint32_t first_id, uint32_t count)
+    : first_id_(first_id), dense_count_(count), dense_(new SubjectRecord[count]) {}
+
+size_t DataBookManager::slotFor(uint32_t subject_id) const {
+    // Fibonacci hashing: top bits of the product, so consecutive IDs spread out
+    return static_cast<size_t>((subject_id * 2654435769u) >> slot_shift_);
+}
+
+void DataBookManager::growIndex() {
+    size_t capacity = slots_.empty() ? 64 : slots_.size() * 2;
+    slot_shift_ = 32 - static_cast<unsigned>(__builtin_ctzll(capacity));
+    std::vector<Slot> old = std::move(slots_);
+    slots_.assign(capacity, Slot{});
+    for (const Slot& s : old) {
+        if (!s.record) continue;
+        size_t i = slotFor(s.subject_id);
+        while (slots_[i].record) i = (i + 1) & (capacity - 1);
+        slots_[i] = s;
+    }
+}
+
+SubjectRecord& DataBookManager::getOrCreateSparse(uint32_t subject_id) {
+    if (slots_.empty()) growIndex();
+    size_t mask = slots_.size() - 1;
+    size_t i = slotFor(subject_id);
+    for (; slots_[i].record; i = (i + 1) & mask) {
+        if (slots_[i].subject_id == subject_id) return *slots_[i].record;
+    }
+
+    if (2 * (sparse_.size() + 1) > slots_.size()) {
+        growIndex();
+        mask = slots_.size() - 1;
+        for (i = slotFor(subject_id); slots_[i].record; i = (i + 1) & mask) {}
+    }
+    SubjectRecord& rec = sparse_.emplace_back();
+    slots_[i] = Slot{subject_id, &rec};
+    return rec;
 }
@@ -0,0 +1,106 @@
+// emission_throttle.cpp
+#include "emission_throttle.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+bool parse_emission_policy(const std::string& spec, EmissionPolicy& out) {
+    EmissionPolicy policy;
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t comma = spec.find(',', start);
+        if (comma == std::string::npos) comma = spec.size();
+        const std::string item = spec.substr(start, comma - start);
+        start = comma + 1;
+
+        const size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        const std::string key = item.substr(0, eq);
+        const char* value = item.c_str() + eq + 1;
+        char* end = nullptr;
+        if (key == "abs") {
+            long long v = std::strtoll(value, &end, 10);
+            if (*end || v < 0) return false;
+            policy.min_abs_delta = v;
+        } else if (key == "rel") {
+            double v = std::strtod(value, &end);
+            if (*end || !(v >= 0.0)) return false;
+            policy.min_rel_delta_ppb = static_cast<int64_t>(std::llround(v * 1e9));
+        } else if (key == "rate") {
+            double v = std::strtod(value, &end);
+            if (*end || !(v > 0.0)) return false;
+            policy.min_interval_ns = static_cast<uint64_t>(1e9 / v);
+        } else {
+            return false;
+        }
+    }
+    out = policy;
+    return true;
+}
+
+void EmissionThrottle::addRange(uint32_t first_id, uint32_t last_id, const EmissionPolicy& policy) {
+    ranges_.push_back(Range{first_id, last_id, policy});
+}
+
+uint64_t EmissionThrottle::minIntervalNs() const {
+    uint64_t interval = default_.min_interval_ns;
+    for (const Range& r : ranges_) {
+        if (r.policy.limitsRate() && (interval == 0 || r.policy.min_interval_ns < interval)) {
+            interval = r.policy.min_interval_ns;
+        }
+    }
+    return interval;
+}
+
+const EmissionPolicy& EmissionThrottle::policyFor(SubjectRecord& subject, uint32_t subject_id) const {
+    if (!subject.emission_policy) {
+        subject.emission_policy = &default_;
+        for (const Range& r : ranges_) {
+            if (subject_id >= r.first_id && subject_id <= r.last_id) subject.emission_policy = &r.policy;
+        }
+    }
+    return *subject.emission_policy;
+}
+
+bool EmissionThrottle::significant(const EmissionPolicy& policy, const SubjectRecord& subject,
+                                   const int64_t* scores, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const int64_t last = subject.last_sent_scores[i];
+        if (scores[i] == last) continue;
+        const __int128 delta = static_cast<__int128>(scores[i]) - last;
+        const __int128 magnitude = delta < 0 ? -delta : delta;
+        const __int128 base = last < 0 ? -static_cast<__int128>(last) : last;
+        if (magnitude >= policy.min_abs_delta &&
+            magnitude * 1000000000 >= base * policy.min_rel_delta_ppb) {
+            return true;
+        }
+    }
+    return false;
+}
+
+EmissionThrottle::Decision EmissionThrottle::admit(uint32_t subject_id, SubjectRecord& subject,
+                                                   const int64_t* scores, size_t count, uint64_t now) {
+    const EmissionPolicy& policy = policyFor(subject, subject_id);
+    if (!significant(policy, subject, scores, count)) {
+        ++stats_.dropped;
+        return Decision::Drop;
+    }
+    if (policy.limitsRate() && now - subject.last_send_ns < policy.min_interval_ns) {
+        ++stats_.held;
+        if (!subject.throttle_held) {
+            subject.throttle_held = true;
+            subject.throttle_count = static_cast<uint8_t>(count);
+            subject.throttle_subject_id = subject_id;
+            subject.throttle_next = nullptr;
+            if (held_tail_) {
+                held_tail_->throttle_next = &subject;
+            } else {
+                held_head_ = &subject;
+            }
+            held_tail_ = &subject;
+        }
+        return Decision::Hold;
+    }
+    subject.last_send_ns = now;
+    return Decision::Send;
+}
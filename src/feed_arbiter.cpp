@@ -0,0 +1,142 @@
+// feed_arbiter.cpp
+#include "feed_arbiter.hpp"
+#include <poll.h>
+#include <iostream>
+
+FeedArbiter::FeedArbiter(size_t window) : window_(window > 0 ? window : 1) {
+    size_t buckets = 1;
+    while (buckets < 2 * window_) buckets <<= 1;
+    bucket_mask_ = buckets - 1;
+    for (auto& q : expected_) {
+        q.ring.resize(window_);
+        q.buckets.assign(buckets, 0);
+    }
+}
+
+uint64_t FeedArbiter::hashBytes(const uint8_t* data, size_t length) {
+    // FNV-1a; datagrams are small and this runs once per copy
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i) {
+        h ^= data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+void FeedArbiter::expire(size_t feed) {
+    ExpectedQueue& q = expected_[feed];
+    while (q.oldest < q.next) {
+        const Entry& e = q.ring[q.oldest % window_];
+        if (!e.consumed) {
+            if (arrivals_ - e.arrival < window_) break;
+            --q.unconsumed;
+            ++stats_.missed[feed];
+        }
+        ++q.oldest;
+    }
+}
+
+bool FeedArbiter::accept(size_t feed, const uint8_t* data, size_t length) {
+    const uint64_t hash = hashBytes(data, length);
+    ++arrivals_;
+    expire(feed);
+    ExpectedQueue& mine = expected_[feed];
+
+    // Late copy of something the other feed already delivered? The oldest
+    // unconsumed match is the one it stands for.
+    Entry* match = nullptr;
+    for (uint64_t link = mine.buckets[hash & bucket_mask_]; link > mine.oldest;) {
+        Entry& e = mine.ring[(link - 1) % window_];
+        if (!e.consumed && e.hash == hash && e.length == length) match = &e;
+        link = e.older;
+    }
+    if (match) {
+        match->consumed = true;
+        --mine.unconsumed;
+        ++stats_.duplicates[feed];
+        expire(feed);
+        return false;
+    }
+
+    // First arrival: the other feed now owes us a copy
+    ++stats_.wins[feed];
+    const size_t other_feed = 1 - feed;
+    expire(other_feed);
+    ExpectedQueue& other = expected_[other_feed];
+    if (other.next - other.oldest == window_) {
+        // Full of consumed entries held back by an older unconsumed one; forget it
+        if (!other.ring[other.oldest % window_].consumed) {
+            --other.unconsumed;
+            ++stats_.missed[other_feed];
+        }
+        ++other.oldest;
+        expire(other_feed);
+    }
+    const uint64_t seq = other.next++;
+    uint64_t& bucket = other.buckets[hash & bucket_mask_];
+    other.ring[seq % window_] = Entry{hash, length, arrivals_, bucket, false};
+    bucket = seq + 1;
+    ++other.unconsumed;
+    return true;
+}
+
+FeedArbiterStats FeedArbiter::stats() const {
+    FeedArbiterStats out = stats_;
+    for (size_t f = 0; f < NUM_FEEDS; ++f) out.outstanding[f] = expected_[f].unconsumed;
+    return out;
+}
+
+DualFeedReceiver::DualFeedReceiver(const std::string& group_a, uint16_t port_a,
+                                   const std::string& group_b, uint16_t port_b,
+                                   const std::string& interface_name,
+                                   size_t window)
+    : feeds_{UdpReceiver(group_a, port_a, interface_name), UdpReceiver(group_b, port_b, interface_name)},
+      arbiter_(window) {}
+
+void DualFeedReceiver::setTuning(const ReceiveTuning& tuning) {
+    tuning_ = tuning;
+    for (auto& feed : feeds_) feed.setTuning(tuning);
+}
+
+bool DualFeedReceiver::start(UdpReceiver::BatchCallback callback, size_t batch_size) {
+    if (running_) return false;
+    for (auto& feed : feeds_) {
+        if (!feed.open(batch_size)) {
+            std::cerr << "[ERROR] Failed to open A/B feed socket\n";
+            return false;
+        }
+    }
+
+    std::vector<UdpDatagram> winners(batch_size);
+    feeds_[0].applyThreadTuning();
+    // Spinning polls without sleeping; otherwise the timeout is only so stop()
+    // is noticed on an idle feed
+    const int timeout_ms = tuning_.spin ? 0 : 100;
+    running_ = true;
+    while (running_) {
+        pollfd fds[FeedArbiter::NUM_FEEDS];
+        for (size_t f = 0; f < FeedArbiter::NUM_FEEDS; ++f) {
+            fds[f].fd = feeds_[f].fd();
+            fds[f].events = POLLIN;
+            fds[f].revents = 0;
+        }
+        if (poll(fds, FeedArbiter::NUM_FEEDS, timeout_ms) <= 0) continue;
+
+        for (size_t f = 0; f < FeedArbiter::NUM_FEEDS; ++f) {
+            if (!(fds[f].revents & POLLIN)) continue;
+            feeds_[f].pollBatch([&](const UdpDatagram* batch, size_t count) {
+                size_t n = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    if (arbiter_.accept(f, batch[i].data, batch[i].length)) winners[n++] = batch[i];
+                }
+                if (n > 0) callback(winners.data(), n);
+            });
+        }
+    }
+    return true;
+}
+
+void DualFeedReceiver::stop() {
+    running_ = false;
+    for (auto& feed : feeds_) feed.stop();
+}
@@ -0,0 +1,337 @@
+// io_uring_engine.cpp
+#include "io_uring_engine.hpp"
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+constexpr uint64_t RECV_TAG = 1;
+constexpr uint64_t WRITE_TAG = 2;
+
+int sys_io_uring_setup(unsigned entries, io_uring_params* p) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+                       const void* arg, size_t argsz) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz));
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+template <typename T>
+T* ring_ptr(void* base, uint32_t offset) {
+    return reinterpret_cast<T*>(static_cast<uint8_t*>(base) + offset);
+}
+
+} // namespace
+
+IoUringEngine::IoUringEngine(unsigned queue_depth) : queue_depth_(queue_depth) {}
+
+IoUringEngine::~IoUringEngine() {
+    teardown();
+}
+
+void IoUringEngine::teardown() {
+    if (buf_ring_) munmap(buf_ring_, buf_ring_size_);
+    if (sqes_) munmap(sqes_, sqes_size_);
+    if (cq_ring_ && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_) munmap(sq_ring_, sq_ring_size_);
+    if (ring_fd_ >= 0) ::close(ring_fd_);
+    buf_ring_ = nullptr;
+    sqes_ = nullptr;
+    cq_ring_ = nullptr;
+    sq_ring_ = nullptr;
+    ring_fd_ = -1;
+}
+
+bool IoUringEngine::init() {
+    // ring_fd_ stays open only once init() has succeeded
+    if (ring_fd_ >= 0) return true;
+    auto fail = [this] {
+        teardown();
+        return false;
+    };
+
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring_fd_ = sys_io_uring_setup(queue_depth_, &params);
+    if (ring_fd_ < 0) {
+        std::cerr << "[ERROR] io_uring_setup failed: " << std::strerror(errno) << "\n";
+        ring_fd_ = -1;
+        return false;
+    }
+    if (!(params.features & IORING_FEAT_EXT_ARG)) {
+        std::cerr << "[ERROR] io_uring: kernel lacks IORING_FEAT_EXT_ARG\n";
+        return fail();
+    }
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+        sq_ring_ = nullptr;
+        return fail();
+    }
+    if (single_mmap) {
+        cq_ring_ = sq_ring_;
+    } else {
+        cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) {
+            cq_ring_ = nullptr;
+            return fail();
+        }
+    }
+
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return fail();
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    sq_head_ = ring_ptr<unsigned>(sq_ring_, params.sq_off.head);
+    sq_tail_ = ring_ptr<unsigned>(sq_ring_, params.sq_off.tail);
+    sq_mask_ = ring_ptr<unsigned>(sq_ring_, params.sq_off.ring_mask);
+    sq_array_ = ring_ptr<unsigned>(sq_ring_, params.sq_off.array);
+    cq_head_ = ring_ptr<unsigned>(cq_ring_, params.cq_off.head);
+    cq_tail_ = ring_ptr<unsigned>(cq_ring_, params.cq_off.tail);
+    cq_mask_ = ring_ptr<unsigned>(cq_ring_, params.cq_off.ring_mask);
+    cqes_ = ring_ptr<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+
+    // Provided-buffer ring: the kernel picks a free buffer per datagram
+    buf_ring_size_ = NUM_RECV_BUFFERS * sizeof(io_uring_buf);
+    void* br = mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (br == MAP_FAILED) return fail();
+    buf_ring_ = static_cast<io_uring_buf_ring*>(br);
+    // Fault the page in before the kernel pins it, or it pins the shared zero page
+    std::memset(buf_ring_, 0, buf_ring_size_);
+
+    io_uring_buf_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring_);
+    reg.ring_entries = NUM_RECV_BUFFERS;
+    reg.bgid = RECV_BUFFER_GROUP;
+    if (sys_io_uring_register(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        std::cerr << "[ERROR] io_uring buffer ring registration failed: " << std::strerror(errno) << "\n";
+        return fail();
+    }
+
+    recv_buffers_.resize(static_cast<size_t>(NUM_RECV_BUFFERS) * UdpReceiver::MAX_DATAGRAM_SIZE);
+    for (unsigned bid = 0; bid < NUM_RECV_BUFFERS; ++bid) {
+        recycleBuffer(static_cast<uint16_t>(bid));
+    }
+    return true;
+}
+
+void IoUringEngine::recycleBuffer(uint16_t bid) {
+    // Index from the ring base: in C++ the uapi flex-array wrapper puts bufs[] at
+    // offset 8 instead of overlaying it with the tail
+    io_uring_buf* bufs = reinterpret_cast<io_uring_buf*>(buf_ring_);
+    io_uring_buf& buf = bufs[buf_tail_ & (NUM_RECV_BUFFERS - 1)];
+    buf.addr = reinterpret_cast<uint64_t>(recv_buffers_.data() +
+                                          static_cast<size_t>(bid) * UdpReceiver::MAX_DATAGRAM_SIZE);
+    buf.len = UdpReceiver::MAX_DATAGRAM_SIZE;
+    buf.bid = bid;
+    ++buf_tail_;
+    __atomic_store_n(&buf_ring_->tail, buf_tail_, __ATOMIC_RELEASE);
+}
+
+io_uring_sqe* IoUringEngine::getSqe() {
+    unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    unsigned tail = *sq_tail_;
+    if (tail - head >= queue_depth_) {
+        // Ring full: hand what we have to the kernel first
+        if (!enter(0, false)) return nullptr;
+        head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        if (tail - head >= queue_depth_) return nullptr;
+    }
+    unsigned index = tail & *sq_mask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    // No SQPOLL: the kernel only reads SQEs inside io_uring_enter(), so the
+    // caller may still fill this one in after the tail moves
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    ++to_submit_;
+    return sqe;
+}
+
+bool IoUringEngine::enter(unsigned min_complete, bool with_timeout) {
+    unsigned flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    __kernel_timespec ts{0, 100 * 1000 * 1000}; // wake periodically to notice stop()
+    io_uring_getevents_arg arg;
+    std::memset(&arg, 0, sizeof(arg));
+    const void* argp = nullptr;
+    size_t argsz = 0;
+    if (with_timeout) {
+        arg.sigmask_sz = _NSIG / 8;
+        arg.ts = reinterpret_cast<uint64_t>(&ts);
+        flags |= IORING_ENTER_EXT_ARG;
+        argp = &arg;
+        argsz = sizeof(arg);
+    }
+
+    int ret = sys_io_uring_enter(ring_fd_, to_submit_, min_complete, flags, argp, argsz);
+    ++stats_.enters;
+    if (ret < 0) {
+        if (errno == ETIME || errno == EINTR || errno == EAGAIN || errno == EBUSY) return true;
+        std::cerr << "[ERROR] io_uring_enter failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    to_submit_ -= std::min(to_submit_, static_cast<unsigned>(ret));
+    return true;
+}
+
+void IoUringEngine::armRecv(int udp_fd) {
+    io_uring_sqe* sqe = getSqe();
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = udp_fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = RECV_BUFFER_GROUP;
+    sqe->user_data = RECV_TAG;
+    ++stats_.recv_arms;
+}
+
+void IoUringEngine::queueWrite(int fd, const void* data, size_t len) {
+    if (write_fd_ != fd && (write_inflight_ || !pending_.empty())) {
+        flushWrites();
+    }
+    write_fd_ = fd;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    pending_.insert(pending_.end(), bytes, bytes + len);
+}
+
+void IoUringEngine::submitPendingWrite() {
+    if (write_inflight_ || pending_.empty()) return;
+
+    io_uring_sqe* sqe = getSqe();
+    if (!sqe) return;
+    inflight_.swap(pending_);
+    pending_.clear();
+    inflight_offset_ = 0;
+
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = write_fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(inflight_.data());
+    sqe->len = static_cast<uint32_t>(inflight_.size());
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = WRITE_TAG;
+    write_inflight_ = true;
+    ++stats_.writes;
+}
+
+void IoUringEngine::handleWriteCompletion(int res) {
+    if (res <= 0) {
+        std::cerr << "Error: partial or failed send\n";
+        write_failed_ = true;
+        write_inflight_ = false;
+        inflight_.clear();
+        return;
+    }
+    stats_.bytes_written += static_cast<uint64_t>(res);
+    inflight_offset_ += static_cast<size_t>(res);
+    if (inflight_offset_ < inflight_.size()) {
+        // Short write on the stream socket: send the remainder before anything newer
+        io_uring_sqe* sqe = getSqe();
+        if (sqe) {
+            sqe->opcode = IORING_OP_SEND;
+            sqe->fd = write_fd_;
+            sqe->addr = reinterpret_cast<uint64_t>(inflight_.data() + inflight_offset_);
+            sqe->len = static_cast<uint32_t>(inflight_.size() - inflight_offset_);
+            sqe->msg_flags = MSG_NOSIGNAL;
+            sqe->user_data = WRITE_TAG;
+            ++stats_.writes;
+            return;
+        }
+    }
+    write_inflight_ = false;
+    inflight_.clear();
+}
+
+bool IoUringEngine::flushWrites() {
+    if (ring_fd_ < 0) return false;
+    write_failed_ = false;
+    while ((write_inflight_ || !pending_.empty()) && !write_failed_) {
+        submitPendingWrite();
+        if (!enter(1, true)) return false;
+
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+            if (cqe.user_data == WRITE_TAG) {
+                handleWriteCompletion(cqe.res);
+            } else if (cqe.user_data == RECV_TAG && (cqe.flags & IORING_CQE_F_BUFFER)) {
+                // Ingest has stopped; just give the buffer back
+                recycleBuffer(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+            }
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+    return !write_failed_;
+}
+
+bool IoUringEngine::run(int udp_fd, const UdpReceiver::PacketCallback& callback) {
+    if (ring_fd_ < 0 && !init()) return false;
+
+    running_ = true;
+    armRecv(udp_fd);
+
+    while (running_) {
+        submitPendingWrite();
+        if (!enter(1, true)) break;
+
+        bool rearm = false;
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+
+            if (cqe.user_data == WRITE_TAG) {
+                handleWriteCompletion(cqe.res);
+                continue;
+            }
+
+            if (cqe.flags & IORING_CQE_F_BUFFER) {
+                uint16_t bid = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                if (cqe.res > 0) {
+                    ++stats_.datagrams;
+                    callback(recv_buffers_.data() + static_cast<size_t>(bid) * UdpReceiver::MAX_DATAGRAM_SIZE,
+                             static_cast<size_t>(cqe.res));
+                }
+                recycleBuffer(bid);
+            } else if (cqe.res < 0 && cqe.res != -ENOBUFS && running_) {
+                std::cerr << "[ERROR] io_uring recv failed: " << std::strerror(-cqe.res) << "\n";
+            }
+
+            // The kernel ends a multishot recv on errors or buffer exhaustion
+            if (!(cqe.flags & IORING_CQE_F_MORE)) rearm = true;
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+        if (rearm && running_) armRecv(udp_fd);
+    }
+
+    flushWrites();
+    return true;
+}
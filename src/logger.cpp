@@ -3,6 +3,7 @@
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <mutex>
 
 // bool g_enable_latency_logging = false;
 // void dump_latency_trace(const std::vector<LatencySample>& samples) {
@@ -32,13 +33,15 @@ void append_latency_sample(const LatencySample& s) {
     static std::ofstream out("test_results/latency_trace.csv", std::ios::app);
     
     static bool initialized = false;
+    static std::mutex out_mtx; // shards append from their own threads
+    std::lock_guard<std::mutex> lock(out_mtx);
 
     
 
     if (!initialized) {
         std::filesystem::create_directories("test_results");
         // out << "subject_id,t_recv,t_parsed,t_calc_start,t_calc_end,t_sent\n";
-        out << "subject_id,t_recv,t_parsed,t_calc_start,t_calc_end,t_sent,num_updates\n";
+        out << "subject_id,t_kernel_rx,t_recv,t_parsed,t_calc_start,t_calc_end,t_sent,num_updates\n";
 
         initialized = true;
     }
@@ -46,6 +49,7 @@ void append_latency_sample(const LatencySample& s) {
     
 
     out << s.subject_id << ","
+        << s.t_kernel_rx << ","
         << s.t_recv << ","
         << s.t_parsed << ","
         << s.t_calc_start << ","
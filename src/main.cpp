@@ -8,6 +8,14 @@
 #include "process_packet_core.hpp"
 #include "types.hpp"
 #include "parser_utils.hpp" 
+#include "sharded_engine.hpp"
+#include "sharded_ingest.hpp"
+#include "io_uring_engine.hpp"
+#include "feed_arbiter.hpp"
+#include "replay_source.hpp"
+#include "score_batch.hpp"
+#include "emission_throttle.hpp"
+#include "pipeline.hpp"
 
 #include <iostream>
 #include <csignal>
@@ -17,6 +25,7 @@
 #include <cstring>
 #include <cstdlib>
 #include <filesystem>
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -27,10 +36,31 @@ void signalHandler(int) {
     std::cerr << "\n[INFO] Caught SIGINT, stopping receiver...\n";
 }
 
+// "FIRST-LAST" into first <= last; reports errors against option
+static bool parse_id_range(const char* option, const std::string& range, uint32_t& first, uint32_t& last) {
+    auto dash = range.find('-');
+    if (dash == std::string::npos) {
+        std::cerr << option << " expects FIRST-LAST\n";
+        return false;
+    }
+    first = static_cast<uint32_t>(std::stoul(range.substr(0, dash)));
+    last = static_cast<uint32_t>(std::stoul(range.substr(dash + 1)));
+    if (last < first) {
+        std::cerr << option << " expects FIRST <= LAST\n";
+        return false;
+    }
+    return true;
+}
+
 int main(int argc, char* argv[]) {
-    if (argc != 6) {
+    if (argc < 6) {
         std::cerr << "Usage: " << argv[0]
-                  << " <mcast_ip> <mcast_port> <interface> <endpointA_host> <endpointA_port>\n";
+                  << " <mcast_ip> <mcast_port> <interface> <endpointA_host> <endpointA_port>"
+                  << " [--batch N] [--shards N] [--io-uring]"
+                  << " [--spin] [--cpu N] [--sched-fifo] [--feed-b ip[:port]]"
+                  << " [--replay file [--replay-rate PPS | --replay-original] [--replay-loops N]]"
+                  << " [--subject-ids FIRST-LAST] [--score NAME[,NAME...]] [--analytics] [--conflate | --conflate-us N]"
+                  << " [--throttle SPEC] [--throttle-range FIRST-LAST SPEC] [--pipeline | --workers N]\n";
         return 1;
     }
 
@@ -40,9 +70,187 @@ int main(int argc, char* argv[]) {
     std::string endpointA_host = argv[4];
     uint16_t endpointA_port = static_cast<uint16_t>(std::stoi(argv[5]));
 
-    DataBookManager book_manager;
-    CompositeScoreCalculator calculator;
+    size_t batch_size = 0; // 0 = one recv() per datagram
+    size_t num_shards = 0; // 0 = single socket, everything on recv_thread
+    bool use_io_uring = false;
+    ReceiveTuning tuning;
+    std::string feed_b_ip;  // empty = single feed
+    uint16_t feed_b_port = mcast_port;
+    std::string replay_path;  // non-empty = read frames from a capture instead of the socket
+    ReplayPacing replay_pacing;
+    uint64_t replay_loops = 1;
+    uint32_t dense_first_id = 0;  // with dense_count > 0, IDs in range index a flat array
+    uint32_t dense_count = 0;
+    RegisteredScorer calculator;  // "top" unless --score names another policy
+    ScoreSet score_set;           // every --score policy; more than one = multi-score records
+    bool record_analytics = false;  // append EWMA/min/max/variance to each record
+    bool conflate = false;        // score and send each subject once per receive batch
+    uint64_t conflate_window_ns = 0;  // > 0: hold queued subjects until the oldest is this old
+    EmissionThrottle throttle;    // --throttle default and --throttle-range policies
+    bool pipelined = false;       // separate receive, compute and egress threads
+    size_t num_workers = 0;       // > 0: receive thread dispatches to subject-owning workers
+    bool throttling = false;
+    for (int i = 6; i < argc; ++i) {
+        std::string opt = argv[i];
+        if (opt == "--batch" && i + 1 < argc) {
+            batch_size = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (opt == "--shards" && i + 1 < argc) {
+            num_shards = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (opt == "--io-uring") {
+            use_io_uring = true;
+        } else if (opt == "--spin") {
+            tuning.spin = true;
+        } else if (opt == "--cpu" && i + 1 < argc) {
+            tuning.cpu = std::stoi(argv[++i]);
+        } else if (opt == "--sched-fifo") {
+            tuning.sched_fifo = true;
+        } else if (opt == "--feed-b" && i + 1 < argc) {
+            feed_b_ip = argv[++i];
+            auto colon = feed_b_ip.find(':');
+            if (colon != std::string::npos) {
+                feed_b_port = static_cast<uint16_t>(std::stoi(feed_b_ip.substr(colon + 1)));
+                feed_b_ip.resize(colon);
+            }
+        } else if (opt == "--replay" && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (opt == "--replay-rate" && i + 1 < argc) {
+            replay_pacing.mode = ReplayPacing::Mode::FixedRate;
+            replay_pacing.rate_pps = std::stod(argv[++i]);
+        } else if (opt == "--replay-original") {
+            replay_pacing.mode = ReplayPacing::Mode::Original;
+        } else if (opt == "--replay-loops" && i + 1 < argc) {
+            replay_loops = std::stoull(argv[++i]);
+        } else if (opt == "--subject-ids" && i + 1 < argc) {
+            uint32_t first, last;
+            if (!parse_id_range("--subject-ids", argv[++i], first, last)) return 1;
+            dense_first_id = first;
+            dense_count = last - first + 1;
+        } else if (opt == "--score" && i + 1 < argc) {
+            // NAME, or NAME,NAME,... for one record of several scores
+            std::string names = argv[++i];
+            score_set = ScoreSet();
+            for (size_t start = 0; start <= names.size();) {
+                size_t comma = std::min(names.find(',', start), names.size());
+                std::string name = names.substr(start, comma - start);
+                start = comma + 1;
+                const ScorerInfo* info = find_scorer(name);
+                if (!info) {
+                    std::cerr << "Unknown scoring policy: " << name << ". Available:\n";
+                    for (const ScorerInfo* s = scorer_registry(); s->name; ++s) {
+                        std::cerr << "  " << s->name << "  " << s->description << "\n";
+                    }
+                    return 1;
+                }
+                if (!score_set.add(*info)) {
+                    std::cerr << "--score takes at most " << MAX_SCORE_OUTPUTS << " policies\n";
+                    return 1;
+                }
+            }
+            calculator = RegisteredScorer(score_set.scorer(0));
+        } else if (opt == "--throttle" && i + 1 < argc) {
+            EmissionPolicy policy;
+            if (!parse_emission_policy(argv[++i], policy)) {
+                std::cerr << "--throttle expects abs=N,rel=F,rate=HZ (any subset)\n";
+                return 1;
+            }
+            throttle.setDefault(policy);
+            throttling = true;
+        } else if (opt == "--throttle-range" && i + 2 < argc) {
+            uint32_t first, last;
+            if (!parse_id_range("--throttle-range", argv[++i], first, last)) return 1;
+            EmissionPolicy policy;
+            if (!parse_emission_policy(argv[++i], policy)) {
+                std::cerr << "--throttle-range expects FIRST-LAST abs=N,rel=F,rate=HZ (any subset)\n";
+                return 1;
+            }
+            throttle.addRange(first, last, policy);
+            throttling = true;
+        } else if (opt == "--pipeline") {
+            pipelined = true;
+        } else if (opt == "--workers" && i + 1 < argc) {
+            num_workers = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (opt == "--analytics") {
+            record_analytics = true;
+        } else if (opt == "--conflate") {
+            conflate = true;
+        } else if (opt == "--conflate-us" && i + 1 < argc) {
+            conflate = true;
+            conflate_window_ns = std::stoull(argv[++i]) * 1000;
+        } else {
+            std::cerr << "Unknown option: " << opt << "\n";
+            return 1;
+        }
+    }
+    // Several policies are scored together over one book snapshot; a single
+    // one keeps the level-0 kernel and the 12-byte record
+    const bool multi_score = score_set.size() > 1;
+    if (use_io_uring && num_shards > 0) {
+        std::cerr << "--io-uring drives a single socket and cannot be combined with --shards\n";
+        return 1;
+    }
+    if (!feed_b_ip.empty() && (use_io_uring || num_shards > 0)) {
+        std::cerr << "--feed-b arbitrates on one thread and cannot be combined with --io-uring or --shards\n";
+        return 1;
+    }
+
+    if ((conflate || throttling) && num_shards > 0) {
+        std::cerr << "--conflate and --throttle need the single-thread receive path and cannot be combined with --shards\n";
+        return 1;
+    }
+    // Held values (a conflation window, rate-limited sends) are released by the
+    // receive loop, which must wake up even when no traffic arrives; with
+    // --pipeline or --workers the processing threads wake up instead
+    const bool polled = pipelined || num_workers > 0;
+    uint64_t hold_ns = conflate_window_ns;
+    const uint64_t send_interval_ns = throttling ? throttle.minIntervalNs() : 0;
+    if (send_interval_ns > 0 && (hold_ns == 0 || send_interval_ns < hold_ns)) hold_ns = send_interval_ns;
+    if (hold_ns > 0 && !polled && (use_io_uring || !feed_b_ip.empty())) {
+        std::cerr << "--conflate-us and --throttle rate= need the recvmmsg() or replay loop, --pipeline or --workers"
+                  << " and cannot be combined with --io-uring or --feed-b\n";
+        return 1;
+    }
+    if (hold_ns > 0 && !polled) tuning.idle_wake_us = static_cast<int>(std::max<uint64_t>(hold_ns / 1000, 1));
+    if (pipelined && (num_shards > 0 || use_io_uring)) {
+        std::cerr << "--pipeline cannot be combined with --shards or --io-uring\n";
+        return 1;
+    }
+    if (num_workers > 0 && (pipelined || num_shards > 0 || use_io_uring)) {
+        std::cerr << "--workers cannot be combined with --pipeline, --shards or --io-uring\n";
+        return 1;
+    }
+
+    if (!replay_path.empty() && (use_io_uring || num_shards > 0 || !feed_b_ip.empty())) {
+        std::cerr << "--replay replaces network ingest and cannot be combined with --io-uring, --shards or --feed-b\n";
+        return 1;
+    }
+
+    std::unique_ptr<ReplaySource> replay;
+    if (!replay_path.empty()) {
+        replay = std::make_unique<ReplaySource>(replay_path);
+        if (!replay->open(replay_pacing)) return 1;
+    }
+
+    auto make_books = [&]() {
+        return dense_count > 0 ? std::make_unique<DataBookManager>(dense_first_id, dense_count)
+                               : std::make_unique<DataBookManager>();
+    };
+    // What one processing thread owns: its subjects' books and last-sent
+    // state, the receive batch being scored and its copy of the throttle
+    struct WorkerState {
+        std::unique_ptr<DataBookManager> books;
+        ScoreBatch score_batch;
+        EmissionThrottle throttle;
+    };
+    auto make_state = [&]() {
+        auto st = std::make_unique<WorkerState>();
+        st->books = make_books();
+        st->score_batch.setConflate(conflate);
+        st->throttle = throttle;
+        return st;
+    };
+    std::unique_ptr<WorkerState> main_state = make_state();
     TcpSender sender(endpointA_host, endpointA_port);
+    sender.setRecordAnalytics(record_analytics);
     std::vector<LatencySample> latency_samples;
 
 
@@ -52,26 +260,194 @@ int main(int argc, char* argv[]) {
     }
 
     UdpReceiver receiver(mcast_ip, mcast_port, interface_name);
+    receiver.setTuning(tuning);
     std::signal(SIGINT, signalHandler);
 
-    std::thread recv_thread([&]() {
-        receiver.start([&](const uint8_t* data, size_t len) {
-            
+    // Sharded mode: SO_REUSEPORT sockets feeding subject-affine workers, each
+    // with its own books so no DataBook is shared between threads
+    std::vector<std::unique_ptr<WorkerState>> shard_states;
+    std::unique_ptr<ShardedIngest> sharded;
 
-            ProcessedMessage processed_msg;
-            if (!parse_data_packet(data, len, processed_msg)) {
-                std::cerr << "[ERROR] Failed to parse incoming UDP packet\n";
+    if (num_shards > 0) {
+        for (size_t i = 0; i < num_shards; ++i) {
+            shard_states.push_back(make_state());
+        }
+        sharded = std::make_unique<ShardedIngest>(mcast_ip, mcast_port, interface_name, num_shards,
+                                                  batch_size > 0 ? batch_size : UdpReceiver::DEFAULT_BATCH_SIZE);
+        sharded->start([&](size_t shard, const ProcessedMessage& msg) {
+            WorkerState& st = *shard_states[shard];
+            if (multi_score) {
+                process_decoded_packet(msg, *st.books, score_set, &latency_samples, nullptr, &sender);
             } else {
-                // process_decoded_packet(processed_msg, book_manager, calculator, nullptr, nullptr, -1, &sender);
-                // process_decoded_packet(processed_msg, book_manager, calculator, &latency_samples, nullptr, -1, &sender);
-                process_decoded_packet(processed_msg, book_manager, calculator, &latency_samples, nullptr, -1, &sender);
+                process_decoded_packet(msg, *st.books, calculator, &latency_samples, nullptr, -1, &sender);
+            }
+        });
+    }
 
+    // Where a receive batch can hold several datagrams (recvmmsg() with --batch,
+    // a dual-feed poll, a pipeline or worker queue) or conflation needs one,
+    // messages apply their updates as they are parsed and their subjects are
+    // scored together when the batch ends. Batches of one datagram (the
+    // default, replay, io_uring) have nothing to amortize the queueing over,
+    // so each message is scored directly. out is the TcpSender itself, or the
+    // EgressQueue of a pipeline or worker.
+    const bool staged = conflate || polled || !feed_b_ip.empty() ||
+                        (batch_size > 1 && !use_io_uring && replay_path.empty());
+    auto process_message = [&](WorkerState& st, auto* out, const PacketView& msg) {
+        EmissionThrottle* emission_throttle = throttling ? &st.throttle : nullptr;
+        if (multi_score) {
+            if (staged) {
+                stage_decoded_packet(msg, *st.books, score_set, st.score_batch, &latency_samples, nullptr, out,
+                                     emission_throttle);
+            } else {
+                process_decoded_packet(msg, *st.books, score_set, &latency_samples, nullptr, out, emission_throttle);
+            }
+        } else {
+            if (staged) {
+                stage_decoded_packet(msg, *st.books, calculator, st.score_batch, &latency_samples, nullptr, out,
+                                     emission_throttle);
+            } else {
+                process_decoded_packet(msg, *st.books, calculator, &latency_samples, nullptr, -1, out,
+                                       emission_throttle);
             }
+        }
+    };
+    auto process_packet = [&](WorkerState& st, auto* out, const uint8_t* data, size_t len, uint64_t kernel_rx_ns) {
+        // Views into the receive buffer, so parsing does not allocate; a datagram
+        // may carry several messages, all stamped with its arrival time
+        bool ok = for_each_message(data, len, [&](const PacketView& view) {
+            PacketView processed_msg = view;
+            processed_msg.t_kernel_rx = kernel_rx_ns;
+            process_message(st, out, processed_msg);
+        });
+        if (!ok) {
+            std::cerr << "[ERROR] Failed to parse incoming UDP packet\n";
+        }
+    };
+    auto flush_scores = [&](WorkerState& st, auto* out) {
+        EmissionThrottle* emission_throttle = throttling ? &st.throttle : nullptr;
+        if (multi_score) {
+            flush_score_batch(st.score_batch, score_set, &latency_samples, nullptr, out, emission_throttle);
+        } else {
+            flush_score_batch(st.score_batch, calculator, &latency_samples, nullptr, out, emission_throttle);
+        }
+    };
+    auto finish_batch = [&](WorkerState& st, auto* out) {
+        // With a conflation window, queued subjects wait until the oldest has
+        // been held that long
+        if (conflate_window_ns == 0 || st.score_batch.empty() ||
+            now_ns() - st.score_batch.oldestRecv() >= conflate_window_ns) {
+            flush_scores(st, out);
+        }
+        if (throttling) release_held_scores(st.throttle, now_ns(), out);
+    };
+    // Whatever a conflation window or the throttle still holds, at shutdown
+    auto release_all = [&](WorkerState& st, auto* out) {
+        flush_scores(st, out);
+        if (throttling) release_held_scores(st.throttle, UINT64_MAX, out);
+    };
+
+    // Pipelined mode: the receive thread only copies datagrams into the ingest
+    // ring; a compute thread processes them and an egress thread sends
+    std::unique_ptr<Pipeline> pipeline;
+    if (pipelined) {
+        pipeline = std::make_unique<Pipeline>(sender);
+        // A replay has no socket to drain, so it waits for room instead of dropping
+        pipeline->setBlockWhenFull(replay != nullptr);
+        pipeline->setIdleWake(hold_ns);
+        pipeline->setSpin(tuning.spin);
+    }
 
+    // Worker mode: the receive thread only routes messages; each worker owns
+    // the subjects that hash to it and everything they need
+    std::vector<std::unique_ptr<WorkerState>> worker_states;
+    std::unique_ptr<ShardedEngine> workers;
+    if (num_workers > 0) {
+        for (size_t i = 0; i < num_workers; ++i) worker_states.push_back(make_state());
+        workers = std::make_unique<ShardedEngine>(sender, num_workers);
+        workers->setIdleWake(hold_ns);
+        workers->setSpin(tuning.spin);
+        workers->start(
+            [&](size_t w, const PacketView& msg, EgressQueue& out) { process_message(*worker_states[w], &out, msg); },
+            [&](size_t w, EgressQueue& out) { finish_batch(*worker_states[w], &out); },
+            [&](size_t w, EgressQueue& out) { release_all(*worker_states[w], &out); });
+    }
+
+    auto handle_packet = [&](const uint8_t* data, size_t len, uint64_t kernel_rx_ns) {
+        if (workers) {
+            if (!workers->dispatch(data, len, kernel_rx_ns)) {
+                std::cerr << "[ERROR] Failed to parse incoming UDP packet\n";
+            }
+        } else if (pipelined) {
+            pipeline->pushDatagram(data, len, kernel_rx_ns);
+        } else {
+            process_packet(*main_state, &sender, data, len, kernel_rx_ns);
+        }
+    };
+    auto end_batch = [&]() {
+        if (!polled) finish_batch(*main_state, &sender);
+    };
+    auto handle_one = [&](const uint8_t* data, size_t len, uint64_t kernel_rx_ns) {
+        handle_packet(data, len, kernel_rx_ns);
+        end_batch();
+    };
+    std::thread compute_thread;
+    if (pipelined) {
+        pipeline->startEgress();
+        compute_thread = std::thread([&]() {
+            EgressQueue* egress = &pipeline->egress();
+            pipeline->runCompute(
+                [&](const uint8_t* data, size_t len, uint64_t kernel_rx_ns) {
+                    process_packet(*main_state, egress, data, len, kernel_rx_ns);
+                },
+                [&]() { finish_batch(*main_state, egress); });
+            release_all(*main_state, egress);
         });
+    }
+
+    // io_uring mode: one thread drives both ingest and TCP egress
+    IoUringEngine engine;
+    if (use_io_uring) {
+        if (engine.init()) {
+            sender.attachEngine(&engine);
+        } else {
+            std::cerr << "[WARN] io_uring unavailable, falling back to blocking sockets\n";
+            use_io_uring = false;
+        }
+    }
+
+    // A/B mode: both feeds on one thread, only the first copy of each datagram is processed
+    std::unique_ptr<DualFeedReceiver> dual_feed;
+    if (!feed_b_ip.empty()) {
+        dual_feed = std::make_unique<DualFeedReceiver>(mcast_ip, mcast_port, feed_b_ip, feed_b_port, interface_name);
+        dual_feed->setTuning(tuning);
+    }
+
+    std::atomic<bool> replay_done(false);
+    std::thread recv_thread;
+    if (!sharded) recv_thread = std::thread([&]() {
+        if (replay) {
+            replay->run(handle_one, replay_loops);
+            replay_done = true;
+        } else if (dual_feed) {
+            dual_feed->start([&](const UdpDatagram* batch, size_t count) {
+                for (size_t i = 0; i < count; ++i) {
+                    handle_packet(batch[i].data, batch[i].length, batch[i].kernel_rx_ns);
+                }
+                end_batch();
+            }, batch_size > 0 ? batch_size : UdpReceiver::DEFAULT_BATCH_SIZE);
+        } else if (use_io_uring) {
+            receiver.startUring([&](const uint8_t* data, size_t len) {
+                handle_one(data, len, 0);
+            }, engine);
+        } else {
+            // Handler inlined into the receive loop; without --batch one datagram per call
+            receiver.runBatched(handle_packet, end_batch, batch_size > 0 ? batch_size : 1);
+        }
     });
 
-    for (int i = 0; i < 100; ++i) {
+    // Finite replays end the run as soon as the capture has been consumed
+    for (int i = 0; i < 100 && !replay_done; ++i) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
     keep_running = false;
@@ -80,8 +456,78 @@ int main(int argc, char* argv[]) {
 
 
 
+    if (sharded) sharded->stop();
+    if (dual_feed) dual_feed->stop();
+    if (replay) replay->stop();
     receiver.stop();
-    recv_thread.join();
+    if (recv_thread.joinable()) recv_thread.join();
+    if (workers) {
+        // Each worker drains its inbox and sends what it still holds, then the
+        // egress thread drains their queues
+        workers->stop();
+    } else if (pipelined) {
+        // The compute stage drains the ingest ring and sends what it still
+        // holds, then the egress stage drains its rings
+        pipeline->finishIngest();
+        compute_thread.join();
+        pipeline->stopEgress();
+    } else {
+        // The receive thread is gone
+        release_all(*main_state, &sender);
+    }
+
+    if (replay) {
+        const ReplayStats& rs = replay->stats();
+        double secs = rs.elapsed_ns / 1e9;
+        std::cerr << "[INFO] Replayed " << rs.frames << " frames (" << rs.bytes << " bytes) in "
+                  << secs * 1e3 << " ms: " << (secs > 0 ? rs.frames / secs : 0.0) << " frames/s, "
+                  << (rs.frames > 0 ? static_cast<double>(rs.elapsed_ns) / rs.frames : 0.0) << " ns/frame";
+        if (replay_pacing.mode != ReplayPacing::Mode::MaxSpeed) std::cerr << ", " << rs.late_frames << " late";
+        std::cerr << "\n";
+    }
+    if (pipelined) {
+        const PipelineStats ps = pipeline->stats();
+        std::cerr << "[INFO] Pipeline: ingest ring max depth " << ps.ingest_max_depth << "/"
+                  << Pipeline::INGEST_CAPACITY << ", " << ps.ingest_dropped << " datagrams dropped, "
+                  << ps.ingest_oversized << " oversized dropped; egress ring max depth "
+                  << ps.egress_max_depth << "/" << EgressQueue::RECORD_CAPACITY << ", " << ps.egress_stalls
+                  << " compute stalls\n";
+    }
+    if (workers) {
+        for (size_t w = 0; w < workers->numWorkers(); ++w) {
+            const WorkerStats ws = workers->stats(w);
+            std::cerr << "[INFO] Worker " << w << ": " << ws.messages << " messages, inbox max depth "
+                      << ws.inbox_max_depth << "/" << ShardedEngine::INBOX_CAPACITY << ", " << ws.dispatch_stalls
+                      << " dispatch stalls, " << ws.oversized << " oversized dropped; egress max depth "
+                      << ws.egress_max_depth << "/" << EgressQueue::RECORD_CAPACITY << ", " << ws.egress_stalls
+                      << " stalls\n";
+        }
+    }
+    std::vector<const WorkerState*> states{main_state.get()};
+    for (auto& st : worker_states) states.push_back(st.get());
+    if (conflate) {
+        uint64_t conflated = 0;
+        for (const WorkerState* st : states) conflated += st->score_batch.conflated();
+        std::cerr << "[INFO] Conflated " << conflated << " messages into already queued subjects\n";
+    }
+    if (throttling) {
+        EmissionThrottleStats ts;
+        for (const WorkerState* st : states) {
+            ts.dropped += st->throttle.stats().dropped;
+            ts.held += st->throttle.stats().held;
+            ts.released += st->throttle.stats().released;
+        }
+        std::cerr << "[INFO] Throttle: " << ts.dropped << " changes below threshold, " << ts.held
+                  << " held by the rate limit, " << ts.released << " released later\n";
+    }
+    if (dual_feed) {
+        const FeedArbiterStats fs = dual_feed->stats();
+        for (size_t f = 0; f < FeedArbiter::NUM_FEEDS; ++f) {
+            std::cerr << "[INFO] Feed " << (f == 0 ? 'A' : 'B') << ": " << fs.wins[f] << " won, "
+                      << fs.duplicates[f] << " duplicate, " << fs.missed[f] + fs.outstanding[f]
+                      << " missed\n";
+        }
+    }
 
     // std::cout << "[DEBUG] Total latency samples: " << latency_samples.size() << "\n";
 
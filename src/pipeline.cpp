@@ -0,0 +1,153 @@
+// pipeline.cpp
+#include "pipeline.hpp"
+#include "logger.hpp"
+#include <cstring>
+
+EgressQueue::EgressQueue(bool record_analytics, IdleWaiter& consumer)
+    : record_analytics_(record_analytics),
+      consumer_(consumer),
+      records_(std::make_unique<SpscRing<EgressRecord, RECORD_CAPACITY>>()),
+      latency_(std::make_unique<SpscRing<LatencySample, LATENCY_CAPACITY>>()) {}
+
+void EgressQueue::sendScores(uint32_t subject_id, const int64_t* scores, size_t count,
+                             uint64_t* send_timestamp_ns) {
+    EgressRecord* rec = records_->claim();
+    if (!rec) {
+        stalls_.fetch_add(1, std::memory_order_relaxed);
+        room_.busy();
+        while (!(rec = records_->claim())) room_.idle([this] { return records_->claim() != nullptr; }, 0);
+    }
+    rec->subject_id = subject_id;
+    rec->count = static_cast<uint32_t>(count);
+    std::memcpy(rec->values, scores, count * sizeof(int64_t));
+    records_->publish();
+    consumer_.notify();
+    // Handed over, not yet on the wire
+    if (send_timestamp_ns) *send_timestamp_ns = now_ns();
+}
+
+void EgressQueue::logLatency(const LatencySample& sample) {
+    LatencySample* slot = latency_->claim();
+    if (!slot) {
+        room_.busy();
+        while (!(slot = latency_->claim())) room_.idle([this] { return latency_->claim() != nullptr; }, 0);
+    }
+    *slot = sample;
+    latency_->publish();
+    consumer_.notify();
+}
+
+bool EgressQueue::drain(TcpSender& sender) {
+    bool any = false;
+    // Only what is queued now, so one busy producer cannot starve the others
+    const size_t queued = records_->size();
+    raise_max_depth(max_depth_, queued);
+    for (size_t n = queued; n > 0; --n) {
+        const EgressRecord* rec = records_->front();
+        sender.queueScores(rec->subject_id, rec->values, rec->count);
+        records_->pop();
+        any = true;
+    }
+    if (any) sender.flush();
+    for (size_t n = latency_->size(); n > 0; --n) {
+        sender.logLatency(*latency_->front());
+        latency_->pop();
+        any = true;
+    }
+    if (any) room_.notify();
+    return any;
+}
+
+void run_egress(EgressQueue* const* queues, size_t count, TcpSender& sender, const std::atomic<bool>& done,
+                IdleWaiter& waiter) {
+    auto all_empty = [&] {
+        for (size_t i = 0; i < count; ++i) {
+            if (!queues[i]->empty()) return false;
+        }
+        return true;
+    };
+    for (;;) {
+        bool idle = true;
+        for (size_t i = 0; i < count; ++i) {
+            if (queues[i]->drain(sender)) idle = false;
+        }
+        if (!idle) {
+            waiter.busy();
+            continue;
+        }
+        // Done once the producers have stopped and everything is written
+        if (done.load(std::memory_order_acquire) && all_empty()) break;
+        waiter.idle([&] { return done.load(std::memory_order_acquire) || !all_empty(); }, 0);
+    }
+}
+
+Pipeline::Pipeline(TcpSender& sender)
+    : sender_(sender),
+      egress_(sender.recordAnalytics(), egress_waiter_),
+      ingest_(std::make_unique<SpscRing<DatagramRecord, INGEST_CAPACITY>>()) {}
+
+Pipeline::~Pipeline() {
+    stopEgress();
+}
+
+bool Pipeline::pushDatagram(const uint8_t* data, size_t length, uint64_t kernel_rx_ns) {
+    // A replayed frame can be larger than any UDP datagram
+    if (length > sizeof(DatagramRecord::data)) {
+        ingest_oversized_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    DatagramRecord* rec = ingest_->claim();
+    if (!rec) {
+        if (!block_when_full_) {
+            ingest_dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        ingest_room_.busy();
+        while (!(rec = ingest_->claim())) ingest_room_.idle([this] { return ingest_->claim() != nullptr; }, 0);
+    }
+    rec->kernel_rx_ns = kernel_rx_ns;
+    rec->length = static_cast<uint32_t>(length);
+    std::memcpy(rec->data, data, length);
+    ingest_->publish();
+    compute_waiter_.notify();
+    return true;
+}
+
+void Pipeline::finishIngest() {
+    ingest_done_.store(true, std::memory_order_release);
+    compute_waiter_.notify();
+}
+
+void Pipeline::setSpin(bool enabled) {
+    compute_waiter_.setSpin(enabled);
+    egress_waiter_.setSpin(enabled);
+    ingest_room_.setSpin(enabled);
+    egress_.setSpin(enabled);
+}
+
+void Pipeline::startEgress() {
+    egress_done_ = false;
+    egress_thread_ = std::thread([this] {
+        EgressQueue* queue = &egress_;
+        run_egress(&queue, 1, sender_, egress_done_, egress_waiter_);
+    });
+}
+
+void Pipeline::stopEgress() {
+    egress_done_.store(true, std::memory_order_release);
+    egress_waiter_.notify();
+    if (egress_thread_.joinable()) egress_thread_.join();
+}
+
+PipelineStats Pipeline::stats() const {
+    PipelineStats s;
+    s.ingest_depth = ingest_->size();
+    s.ingest_max_depth = ingest_max_depth_.load(std::memory_order_relaxed);
+    s.ingest_dropped = ingest_dropped_.load(std::memory_order_relaxed);
+    s.ingest_oversized = ingest_oversized_.load(std::memory_order_relaxed);
+    s.egress_depth = egress_.depth();
+    s.egress_max_depth = egress_.maxDepth();
+    s.egress_stalls = egress_.stalls();
+    s.latency_depth = egress_.latencyDepth();
+    return s;
+}
@@ -0,0 +1,123 @@
+// replay_source.cpp
+#include "replay_source.hpp"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace {
+// Closer than this, sleeping overshoots; spin instead
+constexpr uint64_t SPIN_THRESHOLD_NS = 50000;
+}
+
+ReplaySource::ReplaySource(const std::string& path) : path_(path) {}
+
+ReplaySource::~ReplaySource() {
+    unmap();
+}
+
+void ReplaySource::unmap() {
+    if (base_) munmap(const_cast<uint8_t*>(base_), size_);
+    base_ = nullptr;
+    size_ = 0;
+}
+
+bool ReplaySource::open(const ReplayPacing& pacing) {
+    unmap();
+    frame_offsets_.clear();
+    arrival_offsets_.clear();
+    pacing_ = pacing;
+
+    int fd = ::open(path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "[ERROR] Cannot open capture " << path_ << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) < 0 || st.st_size < 4) {
+        std::cerr << "[ERROR] Capture " << path_ << " is empty\n";
+        close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "[ERROR] mmap of " << path_ << " failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    base_ = static_cast<const uint8_t*>(mapped);
+    size_ = static_cast<size_t>(st.st_size);
+    madvise(mapped, size_, MADV_SEQUENTIAL);
+
+    // Index frame boundaries up front so the replay loop does no parsing of its own
+    size_t off = 0;
+    while (off + 4 <= size_) {
+        uint32_t msg_len;
+        std::memcpy(&msg_len, base_ + off, 4);
+        size_t frame_len = 4 + static_cast<size_t>(ntohl(msg_len));
+        if (off + frame_len > size_) break;
+        frame_offsets_.push_back(off);
+        off += frame_len;
+    }
+    if (off != size_) {
+        std::cerr << "[WARN] Ignoring " << size_ - off << " trailing bytes of truncated frame in " << path_ << "\n";
+    }
+    // The last frame ends here, not at the end of the file
+    size_ = off;
+    if (frame_offsets_.empty()) {
+        std::cerr << "[ERROR] No complete frames in " << path_ << "\n";
+        return false;
+    }
+
+    if (pacing_.mode == ReplayPacing::Mode::FixedRate) {
+        if (pacing_.rate_pps <= 0.0) {
+            std::cerr << "[ERROR] Fixed-rate replay needs a positive rate\n";
+            return false;
+        }
+    } else if (pacing_.mode == ReplayPacing::Mode::Original) {
+        std::ifstream ts_file(path_ + ".ts");
+        if (!ts_file) {
+            std::cerr << "[ERROR] Original-timing replay needs " << path_ << ".ts\n";
+            return false;
+        }
+        uint64_t first = 0;
+        uint64_t ts;
+        while (arrival_offsets_.size() < frame_offsets_.size() && ts_file >> ts) {
+            if (arrival_offsets_.empty()) first = ts;
+            arrival_offsets_.push_back(ts >= first ? ts - first : 0);
+        }
+        if (arrival_offsets_.size() != frame_offsets_.size()) {
+            std::cerr << "[ERROR] " << path_ << ".ts has " << arrival_offsets_.size()
+                      << " timestamps for " << frame_offsets_.size() << " frames\n";
+            return false;
+        }
+        // Repeat passes keep the capture's mean gap between its last and first frame
+        uint64_t span = arrival_offsets_.back();
+        loop_span_ns_ = span + (arrival_offsets_.size() > 1 ? span / (arrival_offsets_.size() - 1) : 0);
+    }
+    return true;
+}
+
+uint64_t ReplaySource::scheduleOffset(size_t frame, uint64_t loop) const {
+    if (pacing_.mode == ReplayPacing::Mode::Original) {
+        return loop * loop_span_ns_ + arrival_offsets_[frame];
+    }
+    double index = static_cast<double>(loop) * static_cast<double>(frame_offsets_.size()) + static_cast<double>(frame);
+    return static_cast<uint64_t>(index * 1e9 / pacing_.rate_pps);
+}
+
+bool ReplaySource::waitUntil(uint64_t deadline_ns) {
+    uint64_t now = now_ns();
+    if (now > deadline_ns) return false;
+    if (deadline_ns - now > SPIN_THRESHOLD_NS) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(deadline_ns - now - SPIN_THRESHOLD_NS));
+    }
+    while (now_ns() < deadline_ns) {
+    }
+    return true;
+}
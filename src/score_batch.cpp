@@ -0,0 +1,107 @@
+// score_batch.cpp
+#include "score_batch.hpp"
+#include "scoring_policies.hpp"
+#include <immintrin.h>
+
+namespace {
+
+// Integers below this magnitude convert to and from double exactly with the
+// magic-number trick, and any product or sum below it is exact
+constexpr int64_t EXACT_LIMIT = int64_t(1) << 51;
+constexpr int64_t MAGIC_BITS = 0x4338000000000000LL;   // 2^52 + 2^51 as a double
+constexpr double MAGIC = 6755399441055744.0;
+
+inline int64_t score_one(const TopOfBookBatch& b, size_t i) {
+    return scoring::TopOfBookMidpoint::midpoint(b.demand_value[i], b.demand_volume[i],
+                                                b.supply_value[i], b.supply_volume[i]);
+}
+
+__attribute__((target("avx2")))
+inline __m256d int64_to_double(__m256i v) {
+    return _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(v, _mm256_set1_epi64x(MAGIC_BITS))),
+                         _mm256_set1_pd(MAGIC));
+}
+
+__attribute__((target("avx2")))
+inline __m256i double_to_int64(__m256d v) {
+    return _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(v, _mm256_set1_pd(MAGIC))),
+                            _mm256_set1_epi64x(MAGIC_BITS));
+}
+
+// Lanes with -limit < v < limit
+__attribute__((target("avx2")))
+inline __m256i in_range_epi64(__m256i v) {
+    const __m256i hi = _mm256_set1_epi64x(EXACT_LIMIT);
+    const __m256i lo = _mm256_set1_epi64x(-EXACT_LIMIT);
+    return _mm256_and_si256(_mm256_cmpgt_epi64(hi, v), _mm256_cmpgt_epi64(v, lo));
+}
+
+__attribute__((target("avx2")))
+inline __m256d in_range_pd(__m256d v) {
+    const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    return _mm256_cmp_pd(_mm256_and_pd(v, abs_mask), _mm256_set1_pd(static_cast<double>(EXACT_LIMIT)), _CMP_LT_OQ);
+}
+
+TopOfBookScoreFn select_scorer(const char** name) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "avx2";
+        return score_top_of_book_avx2;
+    }
+    *name = "scalar";
+    return score_top_of_book_scalar;
+}
+
+const char* g_scorer_name = "scalar";
+const TopOfBookScoreFn g_scorer = select_scorer(&g_scorer_name);
+
+}  // namespace
+
+void score_top_of_book_scalar(const TopOfBookBatch& batch, int64_t* out) {
+    for (size_t i = 0; i < batch.count; ++i) out[i] = score_one(batch, i);
+}
+
+__attribute__((target("avx2")))
+void score_top_of_book_avx2(const TopOfBookBatch& batch, int64_t* out) {
+    size_t i = 0;
+    for (; i + 4 <= batch.count; i += 4) {
+        __m256i dv = _mm256_load_si256(reinterpret_cast<const __m256i*>(batch.demand_value + i));
+        __m256i sv = _mm256_load_si256(reinterpret_cast<const __m256i*>(batch.supply_value + i));
+        __m128i dvol = _mm_load_si128(reinterpret_cast<const __m128i*>(batch.demand_volume + i));
+        __m128i svol = _mm_load_si128(reinterpret_cast<const __m128i*>(batch.supply_volume + i));
+        // int addition, wrapping exactly like the scalar total_vol
+        __m128i total = _mm_add_epi32(dvol, svol);
+
+        __m256d dvd = int64_to_double(dv);
+        __m256d svd = int64_to_double(sv);
+        __m256d p1 = _mm256_mul_pd(dvd, _mm256_cvtepi32_pd(svol));
+        __m256d p2 = _mm256_mul_pd(svd, _mm256_cvtepi32_pd(dvol));
+        __m256d num = _mm256_add_pd(p1, p2);
+        // With num exact and |num| < 2^51, the rounded quotient is within half
+        // an ulp of the true one, which never crosses an integer, so truncating
+        // it matches integer division
+        __m256d q = _mm256_round_pd(_mm256_div_pd(num, _mm256_cvtepi32_pd(total)),
+                                    _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), double_to_int64(q));
+
+        __m256d ok = _mm256_and_pd(_mm256_castsi256_pd(_mm256_and_si256(in_range_epi64(dv), in_range_epi64(sv))),
+                                   _mm256_and_pd(_mm256_and_pd(in_range_pd(p1), in_range_pd(p2)), in_range_pd(num)));
+        __m256d nonzero = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(
+            _mm_xor_si128(_mm_cmpeq_epi32(total, _mm_setzero_si128()), _mm_set1_epi32(-1))));
+        int exact = _mm256_movemask_pd(_mm256_and_pd(ok, nonzero));
+        if (exact != 0xF) {
+            for (int lane = 0; lane < 4; ++lane) {
+                if (!(exact & (1 << lane))) out[i + lane] = score_one(batch, i + lane);
+            }
+        }
+    }
+    for (; i < batch.count; ++i) out[i] = score_one(batch, i);
+}
+
+void score_top_of_book(const TopOfBookBatch& batch, int64_t* out) {
+    g_scorer(batch, out);
+}
+
+const char* batch_scorer_name() {
+    return g_scorer_name;
+}
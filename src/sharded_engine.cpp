@@ -0,0 +1,81 @@
+// sharded_engine.cpp
+#include "sharded_engine.hpp"
+#include <cstring>
+
+ShardedEngine::ShardedEngine(TcpSender& sender, size_t num_workers) : sender_(sender) {
+    for (size_t i = 0; i < num_workers; ++i) {
+        auto w = std::make_unique<Worker>();
+        w->inbox = std::make_unique<SpscRing<DatagramRecord, INBOX_CAPACITY>>();
+        w->egress = std::make_unique<EgressQueue>(sender.recordAnalytics(), egress_waiter_);
+        workers_.push_back(std::move(w));
+    }
+}
+
+ShardedEngine::~ShardedEngine() {
+    stop();
+}
+
+bool ShardedEngine::dispatch(const uint8_t* data, size_t length, uint64_t kernel_rx_ns) {
+    const size_t num_workers = workers_.size();
+    return for_each_message(data, length, [&](const PacketView& view) {
+        Worker& dest = *workers_[workerFor(view.subject_id, num_workers)];
+        // The whole frame, so the worker decodes the levels itself
+        const uint8_t* frame = view.updates.data() - MSG_HEADER_SIZE;
+        const size_t frame_len = MSG_HEADER_SIZE + view.updates.size() * UpdateView::RECORD_SIZE;
+        // A replayed frame can carry a message larger than any UDP datagram
+        if (frame_len > sizeof(DatagramRecord::data)) {
+            dest.oversized.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        DatagramRecord* rec = dest.inbox->claim();
+        if (!rec) {
+            dest.dispatch_stalls.fetch_add(1, std::memory_order_relaxed);
+            dispatch_room_.busy();
+            while (!(rec = dest.inbox->claim())) dispatch_room_.idle([&] { return dest.inbox->claim() != nullptr; }, 0);
+        }
+        rec->kernel_rx_ns = kernel_rx_ns;
+        rec->length = static_cast<uint32_t>(frame_len);
+        std::memcpy(rec->data, frame, frame_len);
+        dest.inbox->publish();
+        dest.waiter.notify();
+
+        dest.messages.fetch_add(1, std::memory_order_relaxed);
+    });
+}
+
+void ShardedEngine::stop() {
+    if (!started_) return;
+    started_ = false;
+
+    // Workers first, so everything they send is queued before egress stops
+    dispatch_done_.store(true, std::memory_order_release);
+    for (auto& w : workers_) w->waiter.notify();
+    for (auto& w : workers_) {
+        if (w->thread.joinable()) w->thread.join();
+    }
+    egress_done_.store(true, std::memory_order_release);
+    egress_waiter_.notify();
+    if (egress_thread_.joinable()) egress_thread_.join();
+}
+
+void ShardedEngine::setSpin(bool enabled) {
+    for (auto& w : workers_) {
+        w->waiter.setSpin(enabled);
+        w->egress->setSpin(enabled);
+    }
+    egress_waiter_.setSpin(enabled);
+    dispatch_room_.setSpin(enabled);
+}
+
+WorkerStats ShardedEngine::stats(size_t worker) const {
+    const Worker& w = *workers_[worker];
+    WorkerStats s;
+    s.messages = w.messages.load(std::memory_order_relaxed);
+    s.inbox_max_depth = w.inbox_max_depth.load(std::memory_order_relaxed);
+    s.dispatch_stalls = w.dispatch_stalls.load(std::memory_order_relaxed);
+    s.oversized = w.oversized.load(std::memory_order_relaxed);
+    s.egress_max_depth = w.egress->maxDepth();
+    s.egress_stalls = w.egress->stalls();
+    return s;
+}
@@ -0,0 +1,129 @@
+// sharded_ingest.cpp
+#include "sharded_ingest.hpp"
+#include "parser_utils.hpp"
+#include <iostream>
+
+ShardedIngest::ShardedIngest(const std::string& mcast_ip,
+                             uint16_t mcast_port,
+                             const std::string& interface_name,
+                             size_t num_shards,
+                             size_t batch_size)
+    : batch_size_(batch_size) {
+    for (size_t i = 0; i < num_shards; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->receiver = std::make_unique<UdpReceiver>(mcast_ip, mcast_port, interface_name);
+        shard->receiver->setReusePort(true);
+        shards_.push_back(std::move(shard));
+    }
+    if (!shards_.empty()) multicast_ = shards_[0]->receiver->isMulticast();
+}
+
+ShardedIngest::~ShardedIngest() {
+    stop();
+}
+
+bool ShardedIngest::start(MessageHandler handler) {
+    if (started_ || shards_.empty()) return false;
+    handler_ = std::move(handler);
+    started_ = true;
+
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        shards_[i]->worker_thread = std::thread(&ShardedIngest::workerLoop, this, i);
+        shards_[i]->recv_thread = std::thread(&ShardedIngest::receiveLoop, this, i);
+    }
+    return true;
+}
+
+void ShardedIngest::stop() {
+    if (!started_) return;
+    started_ = false;
+
+    // Stop ingest first so workers can drain everything already routed to them
+    for (auto& shard : shards_) shard->receiver->stop();
+    for (auto& shard : shards_) {
+        if (shard->recv_thread.joinable()) shard->recv_thread.join();
+    }
+
+    for (auto& shard : shards_) {
+        {
+            std::lock_guard<std::mutex> lock(shard->inbox_mtx);
+            shard->stopping = true;
+        }
+        shard->inbox_cv.notify_one();
+    }
+    for (auto& shard : shards_) {
+        if (shard->worker_thread.joinable()) shard->worker_thread.join();
+    }
+}
+
+ShardStats ShardedIngest::stats(size_t shard) const {
+    const Shard& s = *shards_[shard];
+    ShardStats out;
+    out.datagrams = s.receiver->stats().datagrams;
+    out.processed = s.processed;
+    out.rerouted = s.rerouted;
+    return out;
+}
+
+void ShardedIngest::receiveLoop(size_t index) {
+    Shard& self = *shards_[index];
+    const size_t num_shards = shards_.size();
+
+    // Messages are grouped per destination so each inbox is locked once per batch
+    std::vector<std::vector<ProcessedMessage>> outgoing(num_shards);
+
+    bool ok = self.receiver->startBatch([&](const UdpDatagram* batch, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            bool ok = for_each_message(batch[i].data, batch[i].length, [&](const PacketView& view) {
+                size_t owner = shardFor(view.subject_id, num_shards);
+                if (owner != index) {
+                    // Multicast: the owner's socket has its own copy of this datagram
+                    if (multicast_) return;
+                    ++self.rerouted;
+                }
+                // Owning copy: the message outlives the receive buffer in the owner's inbox
+                ProcessedMessage msg;
+                msg.subject_id = view.subject_id;
+                msg.updates.assign(view.updates.begin(), view.updates.end());
+                msg.t_kernel_rx = batch[i].kernel_rx_ns;
+                outgoing[owner].push_back(std::move(msg));
+            });
+            if (!ok) std::cerr << "[ERROR] Failed to parse incoming UDP packet\n";
+        }
+
+        for (size_t owner = 0; owner < num_shards; ++owner) {
+            if (outgoing[owner].empty()) continue;
+            Shard& dest = *shards_[owner];
+            {
+                std::lock_guard<std::mutex> lock(dest.inbox_mtx);
+                for (auto& m : outgoing[owner]) dest.inbox.push_back(std::move(m));
+            }
+            dest.inbox_cv.notify_one();
+            outgoing[owner].clear();
+        }
+    }, batch_size_);
+
+    if (!ok) {
+        std::cerr << "[ERROR] Shard " << index << " failed to open its receive socket\n";
+    }
+}
+
+void ShardedIngest::workerLoop(size_t index) {
+    Shard& self = *shards_[index];
+    std::vector<ProcessedMessage> work;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(self.inbox_mtx);
+            self.inbox_cv.wait(lock, [&] { return !self.inbox.empty() || self.stopping; });
+            if (self.inbox.empty() && self.stopping) break;
+            work.swap(self.inbox);
+        }
+
+        for (const auto& msg : work) {
+            handler_(index, msg);
+        }
+        self.processed += work.size();
+        work.clear();
+    }
+}
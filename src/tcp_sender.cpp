@@ -1,5 +1,6 @@
 #include "tcp_sender.hpp"
 #include "logger.hpp"
+#include "io_uring_engine.hpp"
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <unistd.h>
@@ -8,10 +9,18 @@
 #include <fstream>
 
 std::vector<TcpSendRecord> TcpSender::send_log;
+uint64_t TcpSender::send_log_count = 0;
 std::mutex TcpSender::log_mtx;
 
 TcpSender::TcpSender(const std::string& host, uint16_t port)
-    : host_(host), port_(port) {}
+    : host_(host), port_(port) {
+    std::lock_guard<std::mutex> lg(log_mtx);
+    if (send_log.empty()) send_log.resize(SEND_LOG_CAPACITY);
+}
+
+void TcpSender::logSend(const TcpSendRecord& record) {
+    send_log[send_log_count++ % SEND_LOG_CAPACITY] = record;
+}
 
 TcpSender::~TcpSender() {
     close();
@@ -44,15 +53,24 @@ bool TcpSender::hasScoreChanged(uint32_t subject_id, int64_t new_score) const {
 }
 
 void TcpSender::send(const CompositeScoreMessage& msg, uint64_t* send_timestamp_ns) {
+    sendScores(msg.subject_id, &msg.scaled_composite_score, 1, send_timestamp_ns);
+}
+
+void TcpSender::sendScores(uint32_t subject_id, const int64_t* scores, size_t count, uint64_t* send_timestamp_ns) {
     std::lock_guard<std::mutex> lock(mtx_);
 
-    uint8_t buffer[12];
-    std::memcpy(buffer, &msg.subject_id, 4);
-    std::memcpy(buffer + 4, &msg.scaled_composite_score, 8);
+    uint8_t buffer[4 + 8 * MAX_RECORD_VALUES];
+    const size_t length = 4 + 8 * count;
+    std::memcpy(buffer, &subject_id, 4);
+    std::memcpy(buffer + 4, scores, 8 * count);
 
     size_t total_sent = 0;
-    while (total_sent < sizeof(buffer)) {
-        ssize_t sent = ::send(sockfd_, buffer + total_sent, sizeof(buffer) - total_sent, 0);
+    if (engine_) {
+        engine_->queueWrite(sockfd_, buffer, length);
+        total_sent = length;
+    }
+    while (total_sent < length) {
+        ssize_t sent = ::send(sockfd_, buffer + total_sent, length - total_sent, 0);
         if (sent <= 0) {
             std::cerr << "Error: partial or failed send\n";
             return;
@@ -60,21 +78,68 @@ void TcpSender::send(const CompositeScoreMessage& msg, uint64_t* send_timestamp_
         total_sent += static_cast<size_t>(sent);
     }
 
-    last_sent_[msg.subject_id] = msg.scaled_composite_score;
-
+    const uint64_t t_sent = now_ns();
     if (send_timestamp_ns) {
-        *send_timestamp_ns = now_ns();
+        *send_timestamp_ns = t_sent;
     }
 
     {
         std::lock_guard<std::mutex> lg(log_mtx);
-        send_log.push_back({msg.subject_id, msg.scaled_composite_score, *send_timestamp_ns});
+        logSend({subject_id, scores[0], t_sent});   // first output only
+    }
+}
+
+void TcpSender::queueScores(uint32_t subject_id, const int64_t* scores, size_t count) {
+    const size_t length = 4 + 8 * count;
+    if (pending_.capacity() < COMBINE_BYTES) {
+        pending_.reserve(COMBINE_BYTES);
+        pending_log_.reserve(COMBINE_BYTES / 12);
     }
+    if (pending_.size() + length > COMBINE_BYTES) flush();
+
+    const size_t off = pending_.size();
+    pending_.resize(off + length);
+    std::memcpy(pending_.data() + off, &subject_id, 4);
+    std::memcpy(pending_.data() + off + 4, scores, 8 * count);
+    pending_log_.push_back({subject_id, scores[0], 0});
+}
+
+void TcpSender::flush() {
+    if (pending_.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        size_t total_sent = 0;
+        while (total_sent < pending_.size()) {
+            ssize_t sent = ::send(sockfd_, pending_.data() + total_sent, pending_.size() - total_sent, 0);
+            if (sent <= 0) {
+                std::cerr << "Error: partial or failed send\n";
+                break;
+            }
+            total_sent += static_cast<size_t>(sent);
+        }
+    }
+
+    const uint64_t t_sent = now_ns();
+    {
+        std::lock_guard<std::mutex> lg(log_mtx);
+        for (TcpSendRecord& r : pending_log_) {
+            r.timestamp_ns = t_sent;
+            logSend(r);
+        }
+    }
+    pending_.clear();
+    pending_log_.clear();
+}
+
+void TcpSender::logLatency(const LatencySample& sample) {
+    append_latency_sample(sample);
 }
 
 void TcpSender::sendIfChanged(const CompositeScoreMessage& msg, uint64_t* send_timestamp_ns) {
     if (hasScoreChanged(msg.subject_id, msg.scaled_composite_score)) {
         send(msg, send_timestamp_ns);
+        std::lock_guard<std::mutex> lock(mtx_);
+        last_sent_[msg.subject_id] = msg.scaled_composite_score;
     }
 }
 
@@ -87,7 +152,9 @@ void TcpSender::dumpSendLog(const std::string& filename) {
     std::ofstream out(filename);
     out << "subject_id,scaled_composite_score,timestamp_ns\n";
     std::lock_guard<std::mutex> lock(log_mtx);
-    for (const auto& r : send_log) {
+    const uint64_t first = send_log_count > SEND_LOG_CAPACITY ? send_log_count - SEND_LOG_CAPACITY : 0;
+    for (uint64_t i = first; i < send_log_count; ++i) {
+        const TcpSendRecord& r = send_log[i % SEND_LOG_CAPACITY];
         out << r.subject_id << "," << r.scaled_composite_score << "," << r.timestamp_ns << "\n";
     }
 }
@@ -1,26 +1,105 @@
 // udp_receiver.cpp
 #include "udp_receiver.hpp"
+#include "io_uring_engine.hpp"
+#include "logger.hpp"
 #include <arpa/inet.h>
 #include <net/if.h>
 #include <sys/socket.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
+#include <cerrno>
 #include <cstring>
+#include <ctime>
 #include <iostream>
+#include <vector>
+
+namespace {
+
+constexpr size_t CONTROL_SPACE = CMSG_SPACE(sizeof(timespec));
+
+// SO_TIMESTAMPNS arrival time of a received message, moved onto the now_ns() clock
+uint64_t kernel_rx_ns(msghdr& hdr) {
+    for (cmsghdr* c = CMSG_FIRSTHDR(&hdr); c != nullptr; c = CMSG_NXTHDR(&hdr, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+            timespec ts;
+            std::memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+            return realtime_to_steady_ns(ts);
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+// recvmmsg() state, set up once; each call only rewrites msg_len and msg_controllen
+struct UdpReceiver::BatchBuffers {
+    explicit BatchBuffers(size_t batch_size)
+        : size(batch_size),
+          buffers(batch_size * MAX_DATAGRAM_SIZE),
+          controls((batch_size * CONTROL_SPACE + sizeof(cmsghdr) - 1) / sizeof(cmsghdr)),
+          iovecs(batch_size),
+          headers(batch_size),
+          batch(batch_size) {
+        uint8_t* control_base = reinterpret_cast<uint8_t*>(controls.data());
+        for (size_t i = 0; i < batch_size; ++i) {
+            iovecs[i].iov_base = buffers.data() + i * MAX_DATAGRAM_SIZE;
+            iovecs[i].iov_len = MAX_DATAGRAM_SIZE;
+            std::memset(&headers[i], 0, sizeof(mmsghdr));
+            headers[i].msg_hdr.msg_iov = &iovecs[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+            headers[i].msg_hdr.msg_control = control_base + i * CONTROL_SPACE;
+        }
+    }
+
+    size_t size;
+    std::vector<uint8_t> buffers;
+    std::vector<cmsghdr> controls;
+    std::vector<iovec> iovecs;
+    std::vector<mmsghdr> headers;
+    std::vector<UdpDatagram> batch;
+};
 
 UdpReceiver::UdpReceiver(const std::string& mcast_ip,
                          uint16_t mcast_port,
                          const std::string& interface_name)
     : mcast_ip_(mcast_ip), mcast_port_(mcast_port), interface_name_(interface_name) {}
 
-bool UdpReceiver::start(PacketCallback callback) {
-    if (running_) return false;
+UdpReceiver::~UdpReceiver() {
+    stop();
+}
 
+bool UdpReceiver::openSocket() {
     sockfd_ = socket(AF_INET, SOCK_DGRAM, 0);
     if (sockfd_ < 0) return false;
 
     // Allow reuse
     int reuse = 1;
     setsockopt(sockfd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (reuse_port_ &&
+        setsockopt(sockfd_, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse)) < 0) {
+        close(sockfd_);
+        return false;
+    }
+
+    // Software RX timestamps let the latency trace see socket queueing time
+    int enable = 1;
+    setsockopt(sockfd_, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+
+    if (tuning_.spin) {
+        fcntl(sockfd_, F_SETFL, fcntl(sockfd_, F_GETFL) | O_NONBLOCK);
+        // Raising SO_BUSY_POLL above net.core.busy_read needs CAP_NET_ADMIN;
+        // without it the plain spin still avoids the wakeup
+        if (tuning_.busy_poll_us > 0 &&
+            setsockopt(sockfd_, SOL_SOCKET, SO_BUSY_POLL, &tuning_.busy_poll_us, sizeof(tuning_.busy_poll_us)) < 0) {
+            std::cerr << "[WARN] SO_BUSY_POLL not permitted: " << std::strerror(errno) << "\n";
+        }
+    } else if (tuning_.idle_wake_us > 0) {
+        timeval timeout{tuning_.idle_wake_us / 1000000, tuning_.idle_wake_us % 1000000};
+        setsockopt(sockfd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
 
     sockaddr_in addr = {};
     addr.sin_family = AF_INET;
@@ -32,6 +111,14 @@ bool UdpReceiver::start(PacketCallback callback) {
         return false;
     }
 
+    // A unicast address (e.g. 127.0.0.1 for local benchmarks) needs no group join
+    if (!isMulticast()) return true;
+
+    // Only deliver the group this socket joined, not every group joined on the
+    // host for this port (matters when A/B feeds share a port)
+    int mcast_all = 0;
+    setsockopt(sockfd_, IPPROTO_IP, IP_MULTICAST_ALL, &mcast_all, sizeof(mcast_all));
+
     ip_mreqn mreq = {};
     mreq.imr_multiaddr.s_addr = inet_addr(mcast_ip_.c_str());
     mreq.imr_address.s_addr = INADDR_ANY;
@@ -42,19 +129,148 @@ bool UdpReceiver::start(PacketCallback callback) {
         return false;
     }
 
+    return true;
+}
+
+void UdpReceiver::applyThreadTuning() {
+    if (tuning_.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(tuning_.cpu, &set);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err != 0) {
+            std::cerr << "[WARN] Failed to pin receive thread to CPU " << tuning_.cpu << ": "
+                      << std::strerror(err) << "\n";
+        }
+    }
+    if (tuning_.sched_fifo) {
+        sched_param param{};
+        param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 1;
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err != 0) {
+            std::cerr << "[WARN] SCHED_FIFO not permitted: " << std::strerror(err) << "\n";
+        }
+    }
+}
+
+bool UdpReceiver::isMulticast() const {
+    return IN_MULTICAST(ntohl(inet_addr(mcast_ip_.c_str())));
+}
+
+bool UdpReceiver::start(PacketCallback callback) {
+    return start(TimedPacketCallback([&callback](const uint8_t* data, size_t length, uint64_t) {
+        callback(data, length);
+    }));
+}
+
+bool UdpReceiver::start(TimedPacketCallback callback) {
+    if (running_) return false;
+    if (!openSocket()) return false;
+
+    applyThreadTuning();
     running_ = true;
-    uint8_t buffer[2048];
+    uint8_t buffer[MAX_DATAGRAM_SIZE];
+    alignas(cmsghdr) uint8_t control[CONTROL_SPACE];
+    iovec iov{buffer, sizeof(buffer)};
+    msghdr hdr = {};
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+
     while (running_) {
-        ssize_t len = recv(sockfd_, buffer, sizeof(buffer), 0);
+        hdr.msg_control = control;
+        hdr.msg_controllen = sizeof(control);
+        ssize_t len = recvmsg(sockfd_, &hdr, 0);
         if (len > 0) {
-            callback(buffer, static_cast<size_t>(len));
+            ++stats_.syscalls;
+            ++stats_.datagrams;
+            callback(buffer, static_cast<size_t>(len), kernel_rx_ns(hdr));
+        } else if (tuning_.spin) {
+            ++stats_.empty_polls;
         }
     }
 
     return true;
 }
 
+bool UdpReceiver::open(size_t batch_size) {
+    if (running_ || batch_size == 0) return false;
+    if (!openSocket()) return false;
+    batch_ = std::make_unique<BatchBuffers>(batch_size);
+    return true;
+}
+
+int UdpReceiver::receiveBatch(int flags) {
+    BatchBuffers& b = *batch_;
+    for (size_t i = 0; i < b.size; ++i) {
+        b.headers[i].msg_hdr.msg_controllen = CONTROL_SPACE;
+    }
+    int n = recvmmsg(sockfd_, b.headers.data(), static_cast<unsigned>(b.size), flags, nullptr);
+    if (n <= 0) return n;
+
+    ++stats_.syscalls;
+    size_t count = 0;
+    for (int i = 0; i < n; ++i) {
+        if (b.headers[i].msg_len == 0) continue;
+        b.batch[count].data = static_cast<const uint8_t*>(b.iovecs[i].iov_base);
+        b.batch[count].length = b.headers[i].msg_len;
+        b.batch[count].kernel_rx_ns = kernel_rx_ns(b.headers[i].msg_hdr);
+        ++count;
+    }
+    stats_.datagrams += count;
+    received_ = b.batch.data();
+    return static_cast<int>(count);
+}
+
+int UdpReceiver::receiveBatch(int flags, const BatchCallback& callback) {
+    int n = receiveBatch(flags);
+    if (n > 0) callback(received_, static_cast<size_t>(n));
+    return n;
+}
+
+size_t UdpReceiver::pollBatch(const BatchCallback& callback) {
+    if (!batch_ || sockfd_ < 0) return 0;
+    int n = receiveBatch(MSG_DONTWAIT, callback);
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+bool UdpReceiver::startBatch(BatchCallback callback, size_t batch_size) {
+    if (!open(batch_size)) return false;
+
+    // Blocking: sleep until the first datagram, then take whatever else is queued.
+    // Spin: never sleep; the socket is non-blocking.
+    const int flags = tuning_.spin ? MSG_DONTWAIT : MSG_WAITFORONE;
+
+    applyThreadTuning();
+    running_ = true;
+    while (running_) {
+        if (receiveBatch(flags, callback) <= 0 && tuning_.spin) ++stats_.empty_polls;
+    }
+
+    return true;
+}
+
+bool UdpReceiver::startUring(PacketCallback callback, IoUringEngine& engine) {
+    if (running_) return false;
+    if (!engine.init()) return false;
+    if (!openSocket()) return false;
+
+    applyThreadTuning();
+    running_ = true;
+    engine_ = &engine;
+    bool ok = engine.run(sockfd_, callback);
+    stats_.syscalls = engine.stats().enters;
+    stats_.datagrams = engine.stats().datagrams;
+    engine_ = nullptr;
+    return ok;
+}
+
 void UdpReceiver::stop() {
-    if (sockfd_ >= 0) close(sockfd_);
     running_ = false;
+    if (IoUringEngine* engine = engine_.load()) engine->stop();
+    if (sockfd_ >= 0) {
+        // shutdown() wakes a thread blocked in recv()/recvmmsg(); close() alone does not
+        shutdown(sockfd_, SHUT_RDWR);
+        close(sockfd_);
+    }
+    sockfd_ = -1;
 }
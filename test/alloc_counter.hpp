@@ -0,0 +1,28 @@
+// alloc_counter.hpp
+#pragma once
+
+// Replaces the global operator new and delete with malloc/free wrappers that
+// count every allocation in g_allocations. Include from exactly one
+// translation unit of a test executable, since the replacements are
+// definitions.
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+static size_t g_allocations = 0;
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    ++g_allocations;
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
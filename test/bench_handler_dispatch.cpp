@@ -0,0 +1,131 @@
+// bench_handler_dispatch.cpp
+// Per-packet cost of handing datagrams to a std::function callback (as
+// UdpReceiver::start/startBatch do) versus a handler passed as a template
+// parameter (UdpReceiver::run). Datagrams are replayed from memory so the
+// numbers show dispatch and processing only, without socket syscalls.
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+#include "../include/udp_receiver.hpp"
+#include "../include/parser_utils.hpp"
+#include "../include/data_book.hpp"
+#include "../include/composite_score_calculator.hpp"
+
+// The std::function loop lives in another translation unit in the service, so
+// keep the compiler from specialising it for the callback here
+__attribute__((noinline)) static void dispatch_function(const UdpDatagram* batch, size_t count,
+                                                        const UdpReceiver::TimedPacketCallback& callback) {
+    for (size_t i = 0; i < count; ++i) {
+        callback(batch[i].data, batch[i].length, batch[i].kernel_rx_ns);
+    }
+}
+
+template <typename Handler>
+static void dispatch_template(const UdpDatagram* batch, size_t count, Handler&& handler) {
+    for (size_t i = 0; i < count; ++i) {
+        handler(batch[i].data, batch[i].length, batch[i].kernel_rx_ns);
+    }
+}
+
+static std::vector<uint8_t> load_capture(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Splits the length-prefixed capture into datagrams as they arrive on the wire
+static std::vector<UdpDatagram> split_frames(const std::vector<uint8_t>& capture) {
+    std::vector<UdpDatagram> frames;
+    size_t off = 0;
+    while (off + 4 <= capture.size()) {
+        uint32_t len_net;
+        std::memcpy(&len_net, capture.data() + off, 4);
+        size_t frame_len = 4 + ntohl(len_net);
+        if (off + frame_len > capture.size()) break;
+        frames.push_back(UdpDatagram{capture.data() + off, frame_len, 0});
+        off += frame_len;
+    }
+    return frames;
+}
+
+// Best-of-reps ns per packet over `passes` replays of the frames
+template <typename Body>
+static double time_per_packet(const std::vector<UdpDatagram>& frames, int passes, Body&& body) {
+    double best = 1e30;
+    for (int rep = 0; rep < 5; ++rep) {
+        auto start = std::chrono::steady_clock::now();
+        for (int p = 0; p < passes; ++p) body(frames.data(), frames.size());
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        best = std::min(best, ns / (static_cast<double>(passes) * frames.size()));
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    std::string path = argc > 1 ? argv[1] : "test_data/input_packets.bin";
+    int passes = argc > 2 ? std::stoi(argv[2]) : 200;
+
+    std::vector<uint8_t> capture = load_capture(path);
+    std::vector<UdpDatagram> frames = split_frames(capture);
+    if (frames.empty()) {
+        std::cerr << "No frames in " << path << "\n";
+        return 1;
+    }
+
+    // Minimal handler: isolates the cost of the call itself
+    uint64_t sink = 0;
+    auto touch = [&sink](const uint8_t* data, size_t len, uint64_t) { sink += data[len - 1]; };
+
+    // Full chain minus egress: parse -> book update -> score
+    DataBookManager books;
+    CompositeScoreCalculator calculator;
+    ProcessedMessage msg;
+    int64_t score_sink = 0;
+    auto process = [&](const uint8_t* data, size_t len, uint64_t) {
+        if (!parse_data_packet(data, len, msg)) return;
+        DataBook& book = books.getOrCreateBook(msg.subject_id);
+        book.applyUpdates(msg.updates);
+        score_sink += calculator.calculateCompositeScore(book);
+    };
+
+    UdpReceiver::TimedPacketCallback touch_fn(touch);
+    UdpReceiver::TimedPacketCallback process_fn(process);
+
+    double touch_function = time_per_packet(frames, passes, [&](const UdpDatagram* b, size_t n) {
+        dispatch_function(b, n, touch_fn);
+    });
+    double touch_template = time_per_packet(frames, passes, [&](const UdpDatagram* b, size_t n) {
+        dispatch_template(b, n, touch);
+    });
+    double process_function = time_per_packet(frames, passes, [&](const UdpDatagram* b, size_t n) {
+        dispatch_function(b, n, process_fn);
+    });
+    double process_template = time_per_packet(frames, passes, [&](const UdpDatagram* b, size_t n) {
+        dispatch_template(b, n, process);
+    });
+
+    std::cout << frames.size() << " frames x " << passes << " passes from " << path << "\n\n";
+    std::cout << std::left << std::setw(22) << "handler"
+              << std::right << std::setw(16) << "function ns/pkt"
+              << std::setw(16) << "template ns/pkt"
+              << std::setw(14) << "saved ns/pkt" << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(22) << "dispatch only"
+              << std::right << std::setw(16) << touch_function
+              << std::setw(16) << touch_template
+              << std::setw(14) << touch_function - touch_template << "\n";
+    std::cout << std::left << std::setw(22) << "parse+book+score"
+              << std::right << std::setw(16) << process_function
+              << std::setw(16) << process_template
+              << std::setw(14) << process_function - process_template << "\n";
+
+    // Keep the results observable
+    if (sink == 42 && score_sink == 42) std::cout << "";
+    return 0;
+}
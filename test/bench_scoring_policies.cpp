@@ -0,0 +1,186 @@
+// bench_scoring_policies.cpp
+// Cost per update of each scoring policy: book update plus score, for every
+// policy instantiated at compile time (ScoringEngine<Policy>) and through the
+// runtime registry (RegisteredScorer). Updates hit random levels of a set of
+// books, so depth policies see realistic snapshots. The last row scores the
+// top-of-book policy through ScoreBatch, as the receive loop does, and checks it
+// against the per-update scores; then three outputs per update are computed
+// as one ScoreSet and as three separate registry scorers.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <array>
+#include "../include/data_book.hpp"
+#include "../include/composite_score_calculator.hpp"
+#include "../include/score_batch.hpp"
+
+constexpr uint32_t NUM_SUBJECTS = 256;
+constexpr size_t NUM_UPDATES = 1 << 16;
+
+struct BenchUpdate {
+    uint32_t subject_id;
+    std::array<DataLevel, 1> levels;   // one-level message
+};
+
+static std::vector<BenchUpdate> make_updates(std::mt19937_64& rng) {
+    std::vector<BenchUpdate> updates(NUM_UPDATES);
+    for (BenchUpdate& u : updates) {
+        u.subject_id = static_cast<uint32_t>(rng() % NUM_SUBJECTS);
+        DataLevel& lvl = u.levels[0];
+        lvl.level = static_cast<uint8_t>(rng() % MAX_BOOK_LEVELS);
+        lvl.side = static_cast<uint8_t>(rng() & 1);
+        lvl.value = 100000000000LL + static_cast<int64_t>(rng() % 1000000000);
+        lvl.volume = 1 + static_cast<uint32_t>(rng() % 1000);
+    }
+    return updates;
+}
+
+// Best-of-reps ns per update for one replay of all updates
+template <typename Calculator>
+static double time_per_update(const std::vector<BenchUpdate>& updates, const Calculator& calculator,
+                              int64_t& checksum) {
+    double best = 1e30;
+    for (int rep = 0; rep < 5; ++rep) {
+        DataBookManager books(0, NUM_SUBJECTS);
+        auto start = std::chrono::steady_clock::now();
+        for (const BenchUpdate& u : updates) {
+            DataBook& book = books.getOrCreateBook(u.subject_id);
+            book.applyUpdates(u.levels);
+            checksum += calculator.calculateCompositeScore(book);
+        }
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / updates.size());
+    }
+    return best;
+}
+
+// As time_per_update, with scores staged in a ScoreBatch and computed together;
+// sums the scores so they can be compared with the one-by-one path
+static double time_per_update_batched(const std::vector<BenchUpdate>& updates, int64_t& sum) {
+    CompositeScoreCalculator calculator;
+    double best = 1e30;
+    for (int rep = 0; rep < 5; ++rep) {
+        DataBookManager books(0, NUM_SUBJECTS);
+        ScoreBatch batch;
+        int64_t rep_sum = 0;
+        auto emit = [&](const PendingScore&, const int64_t* scores, size_t) { rep_sum += scores[0]; };
+        auto start = std::chrono::steady_clock::now();
+        for (const BenchUpdate& u : updates) {
+            SubjectRecord& subject = books.getOrCreate(u.subject_id);
+            if (subject.batch_slot >= 0 || batch.full()) batch.flush(calculator, emit);
+            subject.book.applyUpdates(u.levels);
+            batch.add(PendingScore{u.subject_id, &subject, 0, 0, 0, 1});
+        }
+        batch.flush(calculator, emit);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / updates.size());
+        sum = rep_sum;
+    }
+    return best;
+}
+
+// ns per book of one batch kernel over a full TopOfBookBatch
+static double time_kernel(TopOfBookScoreFn fn, const TopOfBookBatch& batch, int64_t* out) {
+    constexpr int ITERS = 4096;
+    double best = 1e30;
+    for (int rep = 0; rep < 5; ++rep) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERS; ++i) fn(batch, out);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / (ITERS * batch.count));
+    }
+    return best;
+}
+
+// Adapters summing several outputs, so time_per_update can drive them
+struct ScoreSetSum {
+    const ScoreSet& set;
+    int64_t calculateCompositeScore(const DataBook& book) const {
+        int64_t scores[MAX_SCORE_OUTPUTS];
+        set.calculateScores(book, scores);
+        int64_t sum = 0;
+        for (size_t i = 0; i < set.size(); ++i) sum += scores[i];
+        return sum;
+    }
+};
+
+struct SeparateSum {
+    std::vector<RegisteredScorer> scorers;
+    int64_t calculateCompositeScore(const DataBook& book) const {
+        int64_t sum = 0;
+        for (const RegisteredScorer& s : scorers) sum += s.calculateCompositeScore(book);
+        return sum;
+    }
+};
+
+template <typename Policy>
+static void report(const char* name, const std::vector<BenchUpdate>& updates, int64_t& checksum) {
+    double t_static = time_per_update(updates, ScoringEngine<Policy>(), checksum);
+    double t_registry = time_per_update(updates, RegisteredScorer(*find_scorer(name)), checksum);
+    std::cout << std::left << std::setw(10) << name
+              << std::right << std::setw(16) << t_static
+              << std::setw(16) << t_registry << "\n";
+}
+
+int main() {
+    std::mt19937_64 rng(42);
+    std::vector<BenchUpdate> updates = make_updates(rng);
+
+    std::cout << NUM_UPDATES << " single-level updates over " << NUM_SUBJECTS
+              << " books (update + score, ns per update, best of 5)\n\n";
+    std::cout << std::left << std::setw(10) << "policy"
+              << std::right << std::setw(16) << "compile-time"
+              << std::setw(16) << "registry" << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+
+    int64_t checksum = 0;
+    report<scoring::TopOfBookMidpoint>("top", updates, checksum);
+    report<scoring::DepthVwap<3>>("vwap3", updates, checksum);
+    report<scoring::DepthVwap<5>>("vwap5", updates, checksum);
+    report<scoring::DepthVwap<MAX_BOOK_LEVELS>>("vwap10", updates, checksum);
+    report<scoring::ExpWeightedDepth<50>>("exp50", updates, checksum);
+    report<scoring::ExpWeightedDepth<80>>("exp80", updates, checksum);
+
+    int64_t expected = 0;
+    time_per_update(updates, CompositeScoreCalculator(), expected);
+    int64_t batched = 0;
+    double t_batched = time_per_update_batched(updates, batched);
+    std::cout << "\ntop through ScoreBatch (" << batch_scorer_name() << "): " << t_batched
+              << " ns/update, scores " << (batched * 5 == expected ? "match" : "DIFFER") << "\n";
+
+    const char* set_names[] = {"top", "vwap5", "imbalance"};
+    ScoreSet set;
+    SeparateSum separate;
+    for (const char* name : set_names) {
+        set.add(*find_scorer(name));
+        separate.scorers.emplace_back(*find_scorer(name));
+    }
+    int64_t set_sum = 0;
+    int64_t separate_sum = 0;
+    double t_set = time_per_update(updates, ScoreSetSum{set}, set_sum);
+    double t_separate = time_per_update(updates, separate, separate_sum);
+    std::cout << "top+vwap5+imbalance: one snapshot " << t_set << ", separately " << t_separate
+              << " ns/update, scores " << (set_sum == separate_sum ? "match" : "DIFFER") << "\n";
+
+    TopOfBookBatch top;
+    top.count = TopOfBookBatch::CAPACITY;
+    for (size_t i = 0; i < top.count; ++i) {
+        top.demand_value[i] = 100000000000LL + static_cast<int64_t>(rng() % 1000000000);
+        top.supply_value[i] = 100000000000LL + static_cast<int64_t>(rng() % 1000000000);
+        top.demand_volume[i] = 1 + static_cast<int32_t>(rng() % 1000);
+        top.supply_volume[i] = 1 + static_cast<int32_t>(rng() % 1000);
+    }
+    alignas(32) int64_t out[TopOfBookBatch::CAPACITY];
+    std::cout << "top batch kernel, ns per book: scalar " << time_kernel(score_top_of_book_scalar, top, out);
+    if (std::string(batch_scorer_name()) == "avx2")
+        std::cout << ", avx2 " << time_kernel(score_top_of_book_avx2, top, out);
+    std::cout << "\n";
+
+    // Keep the scores observable
+    if (checksum == 42) std::cout << "";
+    return batched * 5 == expected && set_sum == separate_sum ? 0 : 1;
+}
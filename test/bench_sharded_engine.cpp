@@ -0,0 +1,303 @@
+// bench_sharded_engine.cpp
+// Core scaling of the subject-partitioned engine: one dispatcher thread feeds
+// 1, 2, 4 and 8 workers from an in-memory stream of datagrams; every worker
+// updates its books, scores a ScoreSet and queues its records, and the egress
+// thread writes them to a local TCP sink. The first row is the sink alone, the
+// ceiling the workers can scale up to. Each row checks that every subject's
+// messages reached its worker in order and that the sink received the same
+// records as with one worker, and that the oversized messages mixed into the
+// stream were dropped and counted rather than routed. Subject IDs are strided
+// by a power of two, as exchange-assigned IDs often are, so a partitioning
+// that only looks at an ID's low bits would load one worker; each row prints
+// the busiest worker's share of the messages over a fair share.
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <cstring>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../include/sharded_engine.hpp"
+#include "../include/process_packet_core.hpp"
+#include "../include/composite_score_calculator.hpp"
+#include "../include/wire_schema.hpp"
+
+constexpr uint32_t FIRST_SUBJECT = 10000;
+constexpr uint32_t NUM_SUBJECTS = 4096;
+constexpr uint32_t SUBJECT_STRIDE = 64;
+constexpr int LEVELS_PER_MESSAGE = 2;
+// Every OVERSIZED_EVERY messages the stream carries one message too large for
+// an inbox record, as a replay file can, for a subject outside the checked range
+constexpr size_t OVERSIZED_EVERY = 4096;
+constexpr int OVERSIZED_LEVELS = 200;
+constexpr uint32_t OVERSIZED_SUBJECT = FIRST_SUBJECT - 1;
+
+static uint32_t subject_id(uint32_t idx) { return FIRST_SUBJECT + idx * SUBJECT_STRIDE; }
+static uint32_t subject_index(uint32_t id) { return (id - FIRST_SUBJECT) / SUBJECT_STRIDE; }
+
+struct Stream {
+    std::vector<uint8_t> bytes;
+    std::vector<size_t> offsets;   // one datagram per message; offsets.back() == bytes.size()
+    uint64_t oversized = 0;
+};
+
+// Level 0 of every message carries the subject's message sequence number in
+// its value, so a worker can tell if a subject's messages were reordered
+static Stream make_stream(size_t num_messages) {
+    std::mt19937_64 rng(42);
+    std::vector<int64_t> seq(NUM_SUBJECTS, 0);
+    Stream s;
+    const size_t size = wire::message_size(LEVELS_PER_MESSAGE);
+    const size_t big_size = wire::message_size(OVERSIZED_LEVELS);
+    static_assert(wire::message_size(OVERSIZED_LEVELS) > sizeof(DatagramRecord::data), "must not fit a record");
+    DataLevel big[OVERSIZED_LEVELS];
+    for (int l = 0; l < OVERSIZED_LEVELS; ++l) {
+        big[l] = {static_cast<uint8_t>(l % MAX_BOOK_LEVELS), static_cast<uint8_t>(l & 1), 100000000000LL, 1};
+    }
+    s.bytes.reserve(num_messages * size + (num_messages / OVERSIZED_EVERY) * big_size);
+    for (size_t i = 0; i < num_messages; ++i) {
+        if (i % OVERSIZED_EVERY == OVERSIZED_EVERY - 1) {
+            s.offsets.push_back(s.bytes.size());
+            s.bytes.resize(s.bytes.size() + big_size);
+            wire::encode_message(s.bytes.data() + s.offsets.back(), OVERSIZED_SUBJECT, big, OVERSIZED_LEVELS);
+            ++s.oversized;
+        }
+        const uint32_t idx = static_cast<uint32_t>(rng() % NUM_SUBJECTS);
+        DataLevel levels[LEVELS_PER_MESSAGE];
+        levels[0] = {0, static_cast<uint8_t>(rng() & 1), 100000000000LL + ++seq[idx],
+                     1 + static_cast<uint32_t>(rng() % 1000)};
+        levels[1] = {static_cast<uint8_t>(1 + rng() % (MAX_BOOK_LEVELS - 1)), static_cast<uint8_t>(rng() & 1),
+                     100000000000LL + static_cast<int64_t>(rng() % 1000000000),
+                     1 + static_cast<uint32_t>(rng() % 1000)};
+        s.offsets.push_back(s.bytes.size());
+        s.bytes.resize(s.bytes.size() + size);
+        wire::encode_message(s.bytes.data() + s.offsets.back(), subject_id(idx), levels, LEVELS_PER_MESSAGE);
+    }
+    s.offsets.push_back(s.bytes.size());
+    return s;
+}
+
+// Local TCP sink: accepts one connection per run and reads it to EOF, adding
+// up an order-independent checksum of the records
+class Sink {
+public:
+    explicit Sink(size_t values_per_record) : record_size_(4 + 8 * values_per_record) {
+        fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(fd_, (sockaddr*)&addr, sizeof(addr));
+        listen(fd_, 1);
+        socklen_t len = sizeof(addr);
+        getsockname(fd_, (sockaddr*)&addr, &len);
+        port_ = ntohs(addr.sin_port);
+    }
+    ~Sink() { close(fd_); }
+
+    uint16_t port() const { return port_; }
+
+    void start() {
+        records_ = 0;
+        bytes_ = 0;
+        checksum_ = 0;
+        thread_ = std::thread([this] { readAll(); });
+    }
+    void join() { thread_.join(); }
+
+    uint64_t records() const { return records_; }
+    uint64_t bytes() const { return bytes_; }
+    uint64_t checksum() const { return checksum_; }
+
+private:
+    void readAll() {
+        int conn = accept(fd_, nullptr, nullptr);
+        std::vector<uint8_t> buf(256 * 1024);
+        size_t have = 0;
+        for (;;) {
+            ssize_t n = recv(conn, buf.data() + have, buf.size() - have, 0);
+            if (n <= 0) break;
+            have += static_cast<size_t>(n);
+            bytes_ += static_cast<uint64_t>(n);
+            size_t off = 0;
+            for (; have - off >= record_size_; off += record_size_) {
+                uint64_t h = 0;
+                std::memcpy(&h, buf.data() + off, 4);
+                for (size_t v = 4; v < record_size_; v += 8) {
+                    uint64_t x;
+                    std::memcpy(&x, buf.data() + off + v, 8);
+                    h = (h ^ x) * 0x9E3779B97F4A7C15ull;
+                }
+                checksum_ += h;
+                ++records_;
+            }
+            std::memmove(buf.data(), buf.data() + off, have - off);
+            have -= off;
+        }
+        close(conn);
+    }
+
+    size_t record_size_;
+    int fd_ = -1;
+    uint16_t port_ = 0;
+    std::thread thread_;
+    uint64_t records_ = 0;
+    uint64_t bytes_ = 0;
+    uint64_t checksum_ = 0;
+};
+
+struct alignas(64) WorkerState {
+    DataBookManager books;
+    ScoreBatch batch;
+    std::vector<int64_t> last_seq = std::vector<int64_t>(NUM_SUBJECTS, 0);
+    uint64_t order_violations = 0;
+    uint64_t oversized_routed = 0;
+};
+
+struct Result {
+    double secs;
+    uint64_t records;
+    uint64_t bytes;
+    uint64_t checksum;
+    uint64_t order_violations;
+    uint64_t oversized_routed;    // oversized messages that reached a worker
+    uint64_t oversized_dropped;   // as counted by the engine
+    double busiest_share;         // most messages routed to one worker, over a fair share
+};
+
+static Result run_engine(size_t num_workers, const Stream& stream, const ScoreSet& set, Sink& sink) {
+    sink.start();
+    TcpSender sender("127.0.0.1", sink.port());
+    sender.connect();
+
+    std::vector<std::unique_ptr<WorkerState>> states;
+    for (size_t i = 0; i < num_workers; ++i) states.push_back(std::make_unique<WorkerState>());
+    ShardedEngine engine(sender, num_workers);
+    engine.start(
+        [&](size_t w, const PacketView& msg, EgressQueue& out) {
+            WorkerState& st = *states[w];
+            if (msg.subject_id == OVERSIZED_SUBJECT) {
+                ++st.oversized_routed;
+                return;
+            }
+            const int64_t seq = msg.updates[0].value - 100000000000LL;
+            int64_t& last = st.last_seq[subject_index(msg.subject_id)];
+            if (seq != last + 1) ++st.order_violations;
+            last = seq;
+            stage_decoded_packet(msg, st.books, set, st.batch, nullptr, nullptr, &out, nullptr);
+        },
+        [&](size_t w, EgressQueue& out) {
+            flush_score_batch(states[w]->batch, set, nullptr, nullptr, &out, nullptr);
+        },
+        [&](size_t w, EgressQueue& out) {
+            flush_score_batch(states[w]->batch, set, nullptr, nullptr, &out, nullptr);
+        });
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i + 1 < stream.offsets.size(); ++i) {
+        engine.dispatch(stream.bytes.data() + stream.offsets[i], stream.offsets[i + 1] - stream.offsets[i], 0);
+    }
+    engine.stop();
+    uint64_t oversized_dropped = 0;
+    uint64_t routed = 0;
+    uint64_t busiest = 0;
+    for (size_t w = 0; w < num_workers; ++w) {
+        const WorkerStats ws = engine.stats(w);
+        oversized_dropped += ws.oversized;
+        routed += ws.messages;
+        busiest = std::max(busiest, ws.messages);
+    }
+    sender.close();
+    sink.join();
+    auto t1 = std::chrono::steady_clock::now();
+
+    Result r{std::chrono::duration<double>(t1 - t0).count(), sink.records(), sink.bytes(), sink.checksum(), 0, 0,
+             oversized_dropped, routed > 0 ? static_cast<double>(busiest) * num_workers / routed : 0.0};
+    for (auto& st : states) {
+        r.order_violations += st->order_violations;
+        r.oversized_routed += st->oversized_routed;
+    }
+    return r;
+}
+
+// The egress path alone: one thread queues records straight into the sender
+static Result run_sink_only(size_t num_records, size_t values_per_record, Sink& sink) {
+    sink.start();
+    TcpSender sender("127.0.0.1", sink.port());
+    sender.connect();
+    int64_t values[TcpSender::MAX_RECORD_VALUES] = {};
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_records; ++i) {
+        values[0] = static_cast<int64_t>(i);
+        sender.queueScores(subject_id(static_cast<uint32_t>(i % NUM_SUBJECTS)), values, values_per_record);
+    }
+    sender.flush();
+    sender.close();
+    sink.join();
+    auto t1 = std::chrono::steady_clock::now();
+    return Result{std::chrono::duration<double>(t1 - t0).count(), sink.records(), sink.bytes(), 0, 0, 0, 0, 0.0};
+}
+
+static void print_row(const std::string& label, size_t messages, const Result& r, double base_rate) {
+    const double rate = messages / r.secs;
+    std::cout << std::left << std::setw(12) << label << std::right << std::fixed << std::setprecision(0)
+              << std::setw(12) << rate << " msgs/s" << std::setw(12) << (r.records / r.secs) << " records/s"
+              << std::setprecision(1) << std::setw(8) << (r.bytes / r.secs / 1e6) << " MB/s";
+    if (base_rate > 0) {
+        std::cout << std::setprecision(2) << std::setw(7) << (rate / base_rate) << "x" << std::setw(7)
+                  << r.busiest_share << "x busiest worker";
+    }
+    std::cout << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    const size_t num_messages = argc > 1 ? std::stoul(argv[1]) : (1u << 18);
+    const std::string names = argc > 2 ? argv[2] : "vwap10,exp50,exp80,imbalance";
+
+    ScoreSet set;
+    for (size_t start = 0; start <= names.size();) {
+        size_t comma = std::min(names.find(',', start), names.size());
+        const ScorerInfo* info = find_scorer(names.substr(start, comma - start));
+        start = comma + 1;
+        if (!info || !set.add(*info)) {
+            std::cerr << "unknown policy or more than " << MAX_SCORE_OUTPUTS << " policies in " << names << "\n";
+            return 1;
+        }
+    }
+
+    const Stream stream = make_stream(num_messages);
+    Sink sink(set.size());
+    std::cout << "[INFO] " << std::thread::hardware_concurrency() << " hardware threads, " << num_messages
+              << " messages over " << NUM_SUBJECTS << " subjects strided by " << SUBJECT_STRIDE << ", scores "
+              << names << "\n";
+
+    print_row("sink only", num_messages, run_sink_only(num_messages, set.size(), sink), 0);
+
+    bool ok = true;
+    uint64_t reference_checksum = 0;
+    double base_rate = 0;
+    for (size_t workers : {1, 2, 4, 8}) {
+        const Result r = run_engine(workers, stream, set, sink);
+        if (workers == 1) {
+            reference_checksum = r.checksum;
+            base_rate = num_messages / r.secs;
+        }
+        print_row("workers=" + std::to_string(workers), num_messages, r, base_rate);
+        if (r.order_violations != 0 || r.checksum != reference_checksum) {
+            std::cout << "  MISMATCH: " << r.order_violations << " subjects out of order, checksum "
+                      << r.checksum << " vs " << reference_checksum << "\n";
+            ok = false;
+        }
+        if (r.oversized_routed != 0 || r.oversized_dropped != stream.oversized) {
+            std::cout << "  OVERSIZED: " << r.oversized_dropped << " of " << stream.oversized << " dropped, "
+                      << r.oversized_routed << " routed\n";
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+// bench_sharded_ingest.cpp
+// Scaling benchmark for SO_REUSEPORT sharded ingest: throughput of
+// receive -> parse -> book -> score at 1, 2, 4 and 8 shards over loopback UDP.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <cstring>
+#include <string>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../include/sharded_ingest.hpp"
+#include "../include/data_book.hpp"
+#include "../include/composite_score_calculator.hpp"
+#include "../include/types.hpp"
+#include "../include/wire_schema.hpp"
+
+constexpr uint16_t BENCH_PORT = 5601;
+constexpr int NUM_SENDERS = 8;    // distinct source ports so the kernel spreads flows
+constexpr uint32_t NUM_SUBJECTS = 1000;
+
+static std::vector<uint8_t> make_packet(uint32_t sid, int seq) {
+    const DataLevel levels[2] = {
+        {0, 0, 100000000000LL + seq, static_cast<uint32_t>(100 + seq % 50)},
+        {0, 1, 100500000000LL + seq, static_cast<uint32_t>(100 + seq % 50)},
+    };
+    std::vector<uint8_t> pkt(wire::message_size(2));
+    wire::encode_message(pkt.data(), sid, levels, 2);
+    return pkt;
+}
+
+static void blast(int sender_id, int num_packets) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(BENCH_PORT);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    for (int i = 0; i < num_packets; ++i) {
+        auto pkt = make_packet(10000 + (sender_id * 7919 + i) % NUM_SUBJECTS, i);
+        sendto(sock, pkt.data(), pkt.size(), 0, (sockaddr*)&addr, sizeof(addr));
+        if (i % 32 == 31) std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    close(sock);
+}
+
+struct alignas(64) ShardWork {
+    DataBookManager book_manager;
+    CompositeScoreCalculator calculator;
+    std::atomic<uint64_t> processed{0};
+    int64_t checksum = 0;
+};
+
+static void run(size_t num_shards, int packets_per_sender) {
+    ShardedIngest ingest("127.0.0.1", BENCH_PORT, "lo", num_shards);
+    std::vector<std::unique_ptr<ShardWork>> work;
+    for (size_t i = 0; i < num_shards; ++i) work.push_back(std::make_unique<ShardWork>());
+
+    auto total_processed = [&]() {
+        uint64_t n = 0;
+        for (auto& w : work) n += w->processed.load(std::memory_order_relaxed);
+        return n;
+    };
+
+    ingest.start([&](size_t shard, const ProcessedMessage& msg) {
+        ShardWork& w = *work[shard];
+        DataBook& book = w.book_manager.getOrCreateBook(msg.subject_id);
+        book.applyUpdates(msg.updates);
+        w.checksum += w.calculator.calculateCompositeScore(book);
+        w.processed.fetch_add(1, std::memory_order_relaxed);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> senders;
+    for (int s = 0; s < NUM_SENDERS; ++s) senders.emplace_back(blast, s, packets_per_sender);
+    for (auto& t : senders) t.join();
+
+    uint64_t last = 0;
+    do {
+        last = total_processed();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    } while (total_processed() != last);
+    auto t1 = std::chrono::steady_clock::now();
+    ingest.stop();
+
+    uint64_t processed = total_processed();
+    uint64_t rerouted = 0;
+    for (size_t i = 0; i < num_shards; ++i) rerouted += ingest.stats(i).rerouted;
+
+    double secs = std::chrono::duration<double>(t1 - t0).count();
+    uint64_t sent = static_cast<uint64_t>(NUM_SENDERS) * packets_per_sender;
+    std::cout << "shards=" << std::left << std::setw(3) << num_shards
+              << " processed=" << std::setw(8) << processed
+              << " lost=" << std::setw(6) << (sent - processed)
+              << " rerouted=" << std::setw(8) << rerouted
+              << " msgs/s=" << std::fixed << std::setprecision(0) << (processed / secs) << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    int packets_per_sender = argc > 1 ? std::stoi(argv[1]) : 25000;
+
+    std::cout << "[INFO] " << std::thread::hardware_concurrency() << " hardware threads, "
+              << NUM_SENDERS << " senders x " << packets_per_sender << " packets\n";
+    for (size_t shards : {1, 2, 4, 8}) {
+        run(shards, packets_per_sender);
+    }
+    return 0;
+}
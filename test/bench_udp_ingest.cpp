@@ -0,0 +1,123 @@
+// bench_udp_ingest.cpp
+// Compares the single-packet recv() loop against the recvmmsg() batch loop and
+// the io_uring multishot loop: throughput, receive-thread CPU time and syscalls
+// per packet over loopback UDP.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <time.h>
+#include "../include/udp_receiver.hpp"
+#include "../include/io_uring_engine.hpp"
+#include "../include/types.hpp"
+#include "../include/wire_schema.hpp"
+
+constexpr uint16_t BENCH_PORT = 5600;
+
+static std::vector<uint8_t> make_packet(uint32_t sid) {
+    const DataLevel levels[2] = {
+        {0, 0, 100000000000LL, 100},
+        {0, 1, 100500000000LL, 100},
+    };
+    std::vector<uint8_t> pkt(wire::message_size(2));
+    wire::encode_message(pkt.data(), sid, levels, 2);
+    return pkt;
+}
+
+static void blast(int num_packets) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(BENCH_PORT);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    auto pkt = make_packet(10000);
+    for (int i = 0; i < num_packets; ++i) {
+        sendto(sock, pkt.data(), pkt.size(), 0, (sockaddr*)&addr, sizeof(addr));
+        // Let the receiver keep up on small machines; bursts of 32 still queue up
+        if (i % 32 == 31) std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    close(sock);
+}
+
+static uint64_t thread_cpu_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+// batch_size 0 = recv() loop, IO_URING_MODE = io_uring, otherwise recvmmsg() batch size
+constexpr size_t IO_URING_MODE = static_cast<size_t>(-1);
+
+static void run(const std::string& label, int num_packets, size_t batch_size) {
+    UdpReceiver receiver("127.0.0.1", BENCH_PORT, "lo");
+    std::atomic<uint64_t> received{0};
+    uint64_t bytes = 0;
+    uint64_t cpu_ns = 0;
+
+    std::thread recv_thread([&]() {
+        uint64_t cpu_start = thread_cpu_ns();
+        if (batch_size == IO_URING_MODE) {
+            IoUringEngine engine;
+            receiver.startUring([&](const uint8_t*, size_t len) {
+                bytes += len;
+                ++received;
+            }, engine);
+        } else if (batch_size > 0) {
+            receiver.startBatch([&](const UdpDatagram* batch, size_t count) {
+                for (size_t i = 0; i < count; ++i) bytes += batch[i].length;
+                received += count;
+            }, batch_size);
+        } else {
+            receiver.start([&](const uint8_t*, size_t len) {
+                bytes += len;
+                ++received;
+            });
+        }
+        cpu_ns = thread_cpu_ns() - cpu_start;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto t0 = std::chrono::steady_clock::now();
+    blast(num_packets);
+    // Drain whatever is still queued
+    uint64_t last = 0;
+    do {
+        last = received;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    } while (received != last);
+    auto t1 = std::chrono::steady_clock::now();
+
+    receiver.stop();
+    recv_thread.join();
+
+    const auto& st = receiver.stats();
+    double secs = std::chrono::duration<double>(t1 - t0).count();
+    std::cout << std::left << std::setw(14) << label
+              << " received=" << std::setw(8) << received.load()
+              << " lost=" << std::setw(6) << (num_packets - static_cast<int64_t>(received.load()))
+              << " syscalls=" << std::setw(8) << st.syscalls
+              << " syscalls/pkt=" << std::fixed << std::setprecision(3)
+              << (st.datagrams ? static_cast<double>(st.syscalls) / st.datagrams : 0.0)
+              << " cpu_ns/pkt=" << std::setprecision(0)
+              << (received ? static_cast<double>(cpu_ns) / received : 0.0)
+              << " pkts/s=" << (received / secs) << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    int num_packets = argc > 1 ? std::stoi(argv[1]) : 200000;
+
+    run("recv", num_packets, 0);
+    for (size_t batch : {8, 32, 64}) {
+        run("recvmmsg/" + std::to_string(batch), num_packets, batch);
+    }
+    run("io_uring", num_packets, IO_URING_MODE);
+    return 0;
+}
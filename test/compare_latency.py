@@ -0,0 +1,41 @@
+# compare_latency.py
+# Side-by-side latency percentiles for latency_trace.csv files recorded in
+# different receive modes, e.g. blocking recv() vs busy-poll spin.
+#
+# Usage: python3 test/compare_latency.py <label>=<latency_trace.csv> [...]
+import sys
+import pandas as pd
+
+if len(sys.argv) < 2:
+    print("Usage: compare_latency.py <label>=<latency_trace.csv> [...]")
+    sys.exit(1)
+
+percentiles = [.5, .9, .99]
+rows = []
+for arg in sys.argv[1:]:
+    label, path = arg.split("=", 1)
+    lat = pd.read_csv(path).apply(pd.to_numeric, errors="coerce")
+    has_kernel_ts = "t_kernel_rx" in lat.columns and (lat["t_kernel_rx"] > 0).any()
+
+    metrics = {
+        # kernel RX timestamp -> user space: wakeup + receive-queue time
+        "queue_us": (lat["t_recv"] - lat["t_kernel_rx"]) / 1000 if has_kernel_ts else None,
+        "total_us": (lat["t_sent"] - lat["t_recv"]) / 1000,
+        "wire_to_send_us": (lat["t_sent"] - lat["t_kernel_rx"]) / 1000 if has_kernel_ts else None,
+    }
+    for name, series in metrics.items():
+        if series is None:
+            continue
+        desc = series.describe(percentiles=percentiles)
+        rows.append({
+            "mode": label,
+            "metric": name,
+            "count": int(desc["count"]),
+            "p50": desc["50%"],
+            "p90": desc["90%"],
+            "p99": desc["99%"],
+            "max": desc["max"],
+        })
+
+table = pd.DataFrame(rows).round(2)
+print(table.to_string(index=False))
@@ -16,15 +16,23 @@ lat = pd.read_csv(latency_csv)
 
 # Force numeric conversion
 cols = ["t_recv", "t_parsed", "t_calc_start", "t_calc_end", "t_sent", "num_updates"]
+if "t_kernel_rx" in lat.columns:
+    cols.append("t_kernel_rx")
+else:
+    lat["t_kernel_rx"] = 0
 lat[cols] = lat[cols].apply(pd.to_numeric, errors="coerce")
 
 print("[INFO] Computing latency stats...")
 lat["net_us"] = (lat["t_sent"] - lat["t_recv"] - (lat["t_calc_end"] - lat["t_calc_start"])) / 1000
 lat["calc_us"] = (lat["t_calc_end"] - lat["t_calc_start"]) / 1000
 lat["total_us"] = (lat["t_sent"] - lat["t_recv"]) / 1000
+# Time spent in the socket receive queue before user space saw the packet
+# (only where the kernel supplied an RX timestamp)
+lat["queue_us"] = ((lat["t_recv"] - lat["t_kernel_rx"]) / 1000).where(lat["t_kernel_rx"] > 0)
+lat["wire_to_send_us"] = ((lat["t_sent"] - lat["t_kernel_rx"]) / 1000).where(lat["t_kernel_rx"] > 0)
 
 # Summary statistics
-summary = lat[["net_us", "calc_us", "total_us"]].describe(percentiles=[.5, .9, .99]).round(2)
+summary = lat[["queue_us", "net_us", "calc_us", "total_us", "wire_to_send_us"]].describe(percentiles=[.5, .9, .99]).round(2)
 grouped = lat.groupby("num_updates")["net_us"].describe(percentiles=[.5, .9, .99]).round(2)
 grouped_html = grouped.to_html(classes="grouped", border=0)
 
@@ -52,8 +60,8 @@ top5_html = lat.sort_values("total_us", ascending=False).head().to_html(index=Fa
 
 # latency table
 detailed = lat[[
-    "subject_id", "num_updates", "t_recv", "t_parsed", "t_calc_start", "t_calc_end", "t_sent",
-    "net_us", "calc_us", "total_us"
+    "subject_id", "num_updates", "t_kernel_rx", "t_recv", "t_parsed", "t_calc_start", "t_calc_end", "t_sent",
+    "queue_us", "net_us", "calc_us", "total_us"
 ]]
 full_table_html = detailed.round(2).to_html(index=False)
 
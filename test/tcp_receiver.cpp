@@ -6,6 +6,7 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <cstring>
+#include <string>
 
 bool running = true;
 
@@ -20,8 +21,11 @@ int main(int argc, char* argv[]) {
     marker.close();
 
 
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <port>\n";
+    // --analytics: records also carry the service's ewma, min, max, variance
+    bool analytics = argc > 2 && std::string(argv[argc - 1]) == "--analytics";
+    if (analytics) --argc;
+    if (argc != 2 && argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <port> [scores per record] [--analytics]\n";
         return 1;
     }
 
@@ -29,6 +33,12 @@ int main(int argc, char* argv[]) {
 
 
     int port = std::stoi(argv[1]);
+    // Matches the number of policies given to the service's --score
+    const int num_scores = argc == 3 ? std::stoi(argv[2]) : 1;
+    if (num_scores < 1 || num_scores > 4) {
+        std::cerr << "scores per record must be 1-4\n";
+        return 1;
+    }
     const std::string output_file = "test_results/tcp_sent.csv";
 
     signal(SIGINT, handle_sigint);
@@ -74,19 +84,28 @@ int main(int argc, char* argv[]) {
     }
     std::cerr << "[DEBUG] Connection accepted\n";
     std::ofstream out(output_file);
-    out << "subject_id,scaled_score\n";
-
-    uint8_t buffer[12];
+    out << "subject_id,scaled_score";
+    for (int i = 1; i < num_scores; ++i) out << ",scaled_score_" << i;
+    if (analytics) out << ",ewma,min,max,variance";
+    out << "\n";
+
+    // subject_id followed by num_scores scores and the analytics
+    const int num_values = num_scores + (analytics ? 4 : 0);
+    uint8_t buffer[4 + 8 * 8];
+    const size_t record_size = 4 + 8 * static_cast<size_t>(num_values);
     while (running) {
-        ssize_t received = recv(new_socket, buffer, sizeof(buffer), MSG_WAITALL);
+        ssize_t received = recv(new_socket, buffer, record_size, MSG_WAITALL);
         if (received <= 0) break;
 
         uint32_t sid;
-        int64_t scaled;
         std::memcpy(&sid, buffer, 4);
-        std::memcpy(&scaled, buffer + 4, 8);
-
-        out << sid << "," << scaled << "\n";
+        out << sid;
+        for (int i = 0; i < num_values; ++i) {
+            int64_t scaled;
+            std::memcpy(&scaled, buffer + 4 + 8 * i, 8);
+            out << "," << scaled;
+        }
+        out << "\n";
     }
 
     std::cout << "[INFO] TCP Receiver shutting down." << std::endl;
@@ -38,8 +38,12 @@
 #include <unistd.h>
 #include <sstream>
 #include <arpa/inet.h>
+#include <algorithm>
+#include "../include/udp_receiver.hpp"
 
-void send_udp_packets(const std::string& path, const std::string& ip, uint16_t port) {
+// pack > 1 puts up to that many consecutive messages into one datagram,
+// as long as it stays within the receiver's MAX_DATAGRAM_SIZE
+void send_udp_packets(const std::string& path, const std::string& ip, uint16_t port, int pack = 1) {
     int sock = socket(AF_INET, SOCK_DGRAM, 0);
     if (sock < 0) {
         perror("socket");
@@ -58,10 +62,31 @@ void send_udp_packets(const std::string& path, const std::string& ip, uint16_t p
     }
 
     int packet_count = 0;
+    int message_count = 0;
+    std::vector<char> datagram;
+    int datagram_messages = 0;
+
+    auto flush = [&]() {
+        if (datagram.empty()) return;
+        ssize_t sent = sendto(sock, datagram.data(), datagram.size(), 0, (sockaddr*)&addr, sizeof(addr));
+        if (sent < 0) {
+            perror("[ERROR] sendto failed");
+        } 
+        // else {
+        //     std::cerr << "[DEBUG] Sent UDP packet #" << packet_count
+        //               << " of size " << sent << " to " << ip << ":" << port << "\n";
+        // }
+
+        datagram.clear();
+        datagram_messages = 0;
+        ++packet_count;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    };
+
     while (true) {
         uint32_t net_len;
         if (!in.read(reinterpret_cast<char*>(&net_len), sizeof(net_len))) {
-            if (packet_count == 0) {
+            if (message_count == 0) {
                 std::cerr << "[WARN] input file empty or missing length field\n";
             }
             break;
@@ -80,20 +105,14 @@ void send_udp_packets(const std::string& path, const std::string& ip, uint16_t p
             break;
         }
 
-        ssize_t sent = sendto(sock, buf.data(), buf.size(), 0, (sockaddr*)&addr, sizeof(addr));
-        if (sent < 0) {
-            perror("[ERROR] sendto failed");
-        } 
-        // else {
-        //     std::cerr << "[DEBUG] Sent UDP packet #" << packet_count
-        //               << " of size " << sent << " to " << ip << ":" << port << "\n";
-        // }
-
-        ++packet_count;
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (datagram_messages >= pack || datagram.size() + buf.size() > UdpReceiver::MAX_DATAGRAM_SIZE) flush();
+        datagram.insert(datagram.end(), buf.begin(), buf.end());
+        ++datagram_messages;
+        ++message_count;
     }
+    flush();
 
-    std::cerr << "[INFO] Total UDP packets sent: " << packet_count << "\n";
+    std::cerr << "[INFO] Total UDP packets sent: " << packet_count << " (" << message_count << " messages)\n";
     close(sock);
 }
 
@@ -133,8 +152,9 @@ std::vector<CompositeScoreMessage> load_actual(const std::string& path) {
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 6) {
-        std::cerr << "Usage: " << argv[0] << " <mcast_ip> <mcast_port> <interface> <tcp_host> <tcp_port>\n";
+    if (argc < 6) {
+        std::cerr << "Usage: " << argv[0] << " <mcast_ip> <mcast_port> <interface> <tcp_host> <tcp_port>"
+                  << " [--pack N] [service options...]\n";
         return 1;
     }
 
@@ -152,17 +172,35 @@ int main(int argc, char* argv[]) {
 
 
 
+    // --pack N is for the sender here; anything else after the five positional
+    // arguments is passed through to the service
+    int pack = 1;
+    const std::string mcast_port_str = std::to_string(mcast_port);
+    const std::string tcp_port_str = std::to_string(tcp_port);
+    std::vector<char*> service_argv = {
+        const_cast<char*>(service_path.c_str()),
+        const_cast<char*>(mcast_ip.c_str()), const_cast<char*>(mcast_port_str.c_str()),
+        const_cast<char*>(iface.c_str()),
+        const_cast<char*>(tcp_host.c_str()), const_cast<char*>(tcp_port_str.c_str())
+    };
+    for (int i = 6; i < argc; ++i) {
+        if (std::string(argv[i]) == "--pack" && i + 1 < argc) {
+            pack = std::max(1, std::stoi(argv[++i]));
+            continue;
+        }
+        service_argv.push_back(argv[i]);
+    }
+    service_argv.push_back(nullptr);
+
     pid_t pid = fork();
     if (pid == 0) {
-        execl(service_path.c_str(), service_path.c_str(),
-              mcast_ip.c_str(), std::to_string(mcast_port).c_str(), iface.c_str(),
-              tcp_host.c_str(), std::to_string(tcp_port).c_str(), nullptr);
-        perror("execl");
+        execv(service_path.c_str(), service_argv.data());
+        perror("execv");
         exit(1);
     }
 
     std::this_thread::sleep_for(std::chrono::milliseconds(200));
-    send_udp_packets(input_bin, mcast_ip, mcast_port);
+    send_udp_packets(input_bin, mcast_ip, mcast_port, pack);
 
     std::this_thread::sleep_for(std::chrono::milliseconds(1000));
     kill(pid, SIGTERM);  
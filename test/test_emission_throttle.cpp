@@ -0,0 +1,194 @@
+// test_emission_throttle.cpp
+// EmissionThrottle decisions on hand-built subjects: a rate-limited change is
+// held and released once its interval ends, a held change that reverts to the
+// last sent value is not released, a direct send while a change is held is
+// not repeated by the release, relative thresholds measure against the size
+// of a negative base, and the later of two overlapping ranges wins. Holding
+// and releasing are also checked not to allocate.
+#include <iostream>
+#include <cstdint>
+#include <vector>
+#include "../include/emission_throttle.hpp"
+#include "alloc_counter.hpp"
+
+static int g_failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        std::cerr << "FAIL: " << what << "\n";
+        ++g_failures;
+    }
+}
+
+using Decision = EmissionThrottle::Decision;
+
+// A subject that has sent value at time sent_ns
+static void mark_sent(SubjectRecord& subject, int64_t value, uint64_t sent_ns) {
+    subject.sent = true;
+    subject.last_sent_scores[0] = value;
+    subject.scores[0] = value;
+    subject.last_send_ns = sent_ns;
+}
+
+// Applies a new score the way the service does and asks the throttle about it
+static Decision change(EmissionThrottle& throttle, uint32_t id, SubjectRecord& subject, int64_t value,
+                       uint64_t now) {
+    subject.scores[0] = value;
+    Decision d = throttle.admit(id, subject, subject.scores.data(), 1, now);
+    if (d == Decision::Send) subject.last_sent_scores[0] = value;
+    return d;
+}
+
+struct Released {
+    uint32_t subject_id;
+    int64_t value;
+};
+
+// Runs releaseDue, recording what it sends and updating last sent like the service
+static std::vector<Released> release(EmissionThrottle& throttle, uint64_t now) {
+    std::vector<Released> out;
+    throttle.releaseDue(now, [&](uint32_t id, SubjectRecord& subject, size_t count) {
+        for (size_t i = 0; i < count; ++i) subject.last_sent_scores[i] = subject.scores[i];
+        out.push_back(Released{id, subject.scores[0]});
+    });
+    return out;
+}
+
+static EmissionPolicy rate_limited(uint64_t interval_ns) {
+    EmissionPolicy p;
+    p.min_interval_ns = interval_ns;
+    return p;
+}
+
+static void test_hold_then_release() {
+    EmissionThrottle throttle;
+    throttle.setDefault(rate_limited(1000));
+    SubjectRecord s;
+    mark_sent(s, 100, 1000);
+
+    check(change(throttle, 7, s, 200, 1500) == Decision::Hold, "change inside the interval is held");
+    check(change(throttle, 7, s, 250, 1600) == Decision::Hold, "second change inside the interval is held");
+    check(release(throttle, 1999).empty(), "nothing released before the interval ends");
+    std::vector<Released> r = release(throttle, 2000);
+    check(r.size() == 1 && r[0].subject_id == 7 && r[0].value == 250, "latest held value released once due");
+    check(s.last_send_ns == 2000 && !s.throttle_held, "release updates the send time and clears the hold");
+    check(release(throttle, 5000).empty(), "a released subject is not released again");
+    check(throttle.stats().held == 2 && throttle.stats().released == 1, "held and released counts");
+}
+
+static void test_held_value_reverts() {
+    EmissionThrottle throttle;
+    throttle.setDefault(rate_limited(1000));
+    SubjectRecord s;
+    mark_sent(s, 100, 1000);
+
+    check(change(throttle, 7, s, 200, 1500) == Decision::Hold, "change is held");
+    check(change(throttle, 7, s, 100, 1600) == Decision::Drop, "return to the last sent value is dropped");
+    check(release(throttle, 2000).empty(), "a held value back at last sent is not released");
+    check(!s.throttle_held && throttle.stats().released == 0, "the hold is cleared without a send");
+}
+
+static void test_direct_send_while_held() {
+    EmissionThrottle throttle;
+    throttle.setDefault(rate_limited(1000));
+    SubjectRecord s;
+    mark_sent(s, 100, 1000);
+
+    check(change(throttle, 7, s, 200, 1500) == Decision::Hold, "change is held");
+    // Release has not run, and the next change comes after the interval
+    check(change(throttle, 7, s, 300, 2500) == Decision::Send, "change after the interval is sent directly");
+    check(s.throttle_held, "the earlier hold is still queued");
+    check(release(throttle, 2600).empty(), "the hold waits for the interval from the direct send");
+    check(release(throttle, 3500).empty(), "the directly sent value is not sent again");
+    check(!s.throttle_held, "the hold is cleared");
+}
+
+static void test_release_order_and_allocations() {
+    constexpr uint32_t N = 1000;
+    EmissionThrottle throttle;
+    throttle.setDefault(rate_limited(1000));
+    std::vector<SubjectRecord> subjects(N);
+    for (SubjectRecord& s : subjects) mark_sent(s, 100, 1000);
+    // Every subject resolves its policy before the counted pass
+    for (uint32_t i = 0; i < N; ++i) change(throttle, i, subjects[i], 100, 1100);
+    std::vector<Released> r;
+    r.reserve(N);
+
+    const size_t before = g_allocations;
+    // Odd subjects first, so the release order is not the index order
+    for (uint32_t i = 1; i < N; i += 2) change(throttle, i, subjects[i], 200 + i, 1500);
+    for (uint32_t i = 0; i < N; i += 2) change(throttle, i, subjects[i], 200 + i, 1600);
+    throttle.releaseDue(UINT64_MAX, [&](uint32_t id, SubjectRecord& subject, size_t) {
+        r.push_back(Released{id, subject.scores[0]});
+    });
+    const size_t allocations = g_allocations - before;
+
+    check(allocations == 0, "holding and releasing allocate nothing");
+    bool in_order = r.size() == N;
+    for (uint32_t k = 0; in_order && k < N; ++k) {
+        const uint32_t expected = k < N / 2 ? 2 * k + 1 : 2 * (k - N / 2);
+        in_order = r[k].subject_id == expected && r[k].value == 200 + expected;
+    }
+    check(in_order, "shutdown releases every held subject in hold order");
+}
+
+static void test_relative_negative_base() {
+    EmissionThrottle throttle;
+    EmissionPolicy p;
+    p.min_rel_delta_ppb = 100000000;   // 10%
+    throttle.setDefault(p);
+    SubjectRecord s;
+    mark_sent(s, -1000, 0);
+
+    check(change(throttle, 7, s, -950, 10) == Decision::Drop, "5% of a negative base is dropped");
+    check(change(throttle, 7, s, -1099, 20) == Decision::Drop, "9.9% of a negative base is dropped");
+    check(change(throttle, 7, s, -900, 30) == Decision::Send, "10% towards zero is sent");
+    check(change(throttle, 7, s, -990, 40) == Decision::Send, "10% away from zero is sent");
+    check(change(throttle, 7, s, -1000, 50) == Decision::Drop, "1% of the new base is dropped");
+}
+
+static void test_overlapping_ranges() {
+    EmissionThrottle throttle;
+    EmissionPolicy wide;
+    wide.min_abs_delta = 1000;
+    EmissionPolicy narrow;
+    narrow.min_abs_delta = 10;
+    throttle.addRange(100, 199, wide);
+    throttle.addRange(150, 159, narrow);
+    SubjectRecord inner, outer, other;
+    mark_sent(inner, 0, 0);
+    mark_sent(outer, 0, 0);
+    mark_sent(other, 0, 0);
+
+    check(change(throttle, 155, inner, 50, 10) == Decision::Send, "later range applies inside the overlap");
+    check(inner.emission_policy && inner.emission_policy->min_abs_delta == 10, "overlap resolves to the later range");
+    check(change(throttle, 120, outer, 50, 10) == Decision::Drop, "earlier range applies outside the overlap");
+    check(change(throttle, 500, other, 1, 10) == Decision::Send, "default applies outside every range");
+}
+
+static void test_parse_policy() {
+    EmissionPolicy p;
+    check(parse_emission_policy("rate=1000,abs=5,rel=0.25", p), "full policy parses");
+    check(p.min_abs_delta == 5 && p.min_rel_delta_ppb == 250000000 && p.min_interval_ns == 1000000,
+          "parsed policy fields");
+    check(!parse_emission_policy("abs=-1", p), "negative abs rejected");
+    check(!parse_emission_policy("rate=0", p), "zero rate rejected");
+    check(!parse_emission_policy("speed=1", p), "unknown key rejected");
+}
+
+int main() {
+    test_hold_then_release();
+    test_held_value_reverts();
+    test_direct_send_while_held();
+    test_release_order_and_allocations();
+    test_relative_negative_base();
+    test_overlapping_ranges();
+    test_parse_policy();
+
+    if (g_failures > 0) {
+        std::cerr << g_failures << " checks failed\n";
+        return 1;
+    }
+    std::cout << "PASS: emission throttle\n";
+    return 0;
+}
@@ -0,0 +1,104 @@
+// test_score_analytics.cpp
+// ScoreAnalytics against brute force: after every push of a long random
+// series, min, max and variance must equal those recomputed from the last
+// WINDOW samples, and the EWMA must stay within two units of a
+// double-precision reference. The series runs well past 256 samples, so the
+// 8-bit sample numbers of the monotonic queues wrap many times. It mixes
+// negative scores and runs of repeated values, which the queues keep as ties.
+// The sample count must grow to WINDOW and stay there. A constant input must
+// then be reached exactly by the EWMA.
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include "../include/score_analytics.hpp"
+
+struct Expected {
+    int64_t min;
+    int64_t max;
+    int64_t variance;
+};
+
+static Expected brute_force(const std::vector<int64_t>& samples) {
+    const size_t n = std::min<size_t>(samples.size(), ScoreAnalytics::WINDOW);
+    Expected e{samples.back(), samples.back(), 0};
+    __int128 sum = 0;
+    __int128 sum_squares = 0;
+    for (size_t i = samples.size() - n; i < samples.size(); ++i) {
+        const int64_t x = samples[i];
+        e.min = std::min(e.min, x);
+        e.max = std::max(e.max, x);
+        sum += x;
+        sum_squares += static_cast<__int128>(x) * x;
+    }
+    const __int128 m = static_cast<__int128>(n);
+    e.variance = static_cast<int64_t>((m * sum_squares - sum * sum) / (m * m) / 1000000000);
+    return e;
+}
+
+int main() {
+    constexpr size_t NUM_SAMPLES = 5000;
+    std::mt19937_64 rng(7);
+    ScoreAnalytics analytics;
+    std::vector<int64_t> samples;
+    double reference_ewma = 0;
+    size_t mismatches = 0;
+    double max_ewma_error = 0;
+    size_t count_mismatches = 0;
+
+    int64_t score = 100000000000LL;   // 100.0
+    for (size_t i = 0; i < NUM_SAMPLES; ++i) {
+        switch (rng() % 4) {
+        case 0: break;   // repeat: ties in the queues
+        case 1: score += static_cast<int64_t>(rng() % 2000000000) - 1000000000; break;
+        case 2: score = static_cast<int64_t>(rng() % 400000000000ULL) - 200000000000LL; break;   // may go negative
+        default: score += static_cast<int64_t>(rng() % 21) - 10; break;
+        }
+        analytics.push(score);
+        samples.push_back(score);
+        reference_ewma = i == 0 ? score : reference_ewma + (score - reference_ewma) / ScoreAnalytics::EWMA_DIVISOR;
+
+        const Expected e = brute_force(samples);
+        if (analytics.min() != e.min || analytics.max() != e.max || analytics.variance() != e.variance) {
+            if (mismatches++ < 5) {
+                std::cerr << "FAIL: sample " << i << ": min " << analytics.min() << " vs " << e.min << ", max "
+                          << analytics.max() << " vs " << e.max << ", variance " << analytics.variance() << " vs "
+                          << e.variance << "\n";
+            }
+        }
+        max_ewma_error = std::max(max_ewma_error, std::fabs(analytics.ewma() - reference_ewma));
+        if (analytics.count() != std::min<size_t>(i + 1, ScoreAnalytics::WINDOW)) ++count_mismatches;
+    }
+
+    // A constant input after the series: the EWMA must settle on it exactly
+    const int64_t settle = -123456789;
+    for (int i = 0; i < 1000; ++i) analytics.push(settle);
+    const int64_t settled = analytics.ewma();
+
+    std::cout << NUM_SAMPLES << " samples: " << mismatches << " window mismatches, EWMA within "
+              << max_ewma_error << " of the reference, constant input settled at " << settled << "\n";
+
+    bool ok = true;
+    if (count_mismatches != 0 || analytics.count() != ScoreAnalytics::WINDOW) {
+        std::cerr << "FAIL: " << count_mismatches << " samples with the wrong count, final count "
+                  << analytics.count() << "\n";
+        ok = false;
+    }
+    if (mismatches != 0) {
+        std::cerr << "FAIL: " << mismatches << " samples with wrong window statistics\n";
+        ok = false;
+    }
+    if (max_ewma_error > 2.0) {
+        std::cerr << "FAIL: EWMA drifted " << max_ewma_error << " units from the reference\n";
+        ok = false;
+    }
+    if (settled != settle) {
+        std::cerr << "FAIL: EWMA settled at " << settled << " for a constant " << settle << "\n";
+        ok = false;
+    }
+    if (!ok) return 1;
+    std::cout << "PASS: score analytics\n";
+    return 0;
+}
@@ -0,0 +1,91 @@
+// test_shard_spread.cpp
+// Subject-to-shard spread of ShardedIngest::shardFor, which --shards and
+// --workers both route by. Over dense and power-of-two-strided ID sets every
+// shard count from 2 to 16 must give each shard within 5% of a fair share;
+// a hash reduced by its low bits sends a stride of 2^k to one shard. Over the
+// capture, whose few subjects cannot split evenly, every shard count must
+// still use all but at most one of the shards it could.
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <set>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+#include "../include/parser_utils.hpp"
+#include "../include/sharded_ingest.hpp"
+
+static const size_t SHARD_COUNTS[] = {2, 3, 4, 8, 16};
+
+// Largest shard's share of ids over a fair share
+static double worst_share(const std::vector<uint32_t>& ids, size_t num_shards) {
+    std::vector<size_t> per_shard(num_shards, 0);
+    for (uint32_t id : ids) ++per_shard[ShardedIngest::shardFor(id, num_shards)];
+    const size_t largest = *std::max_element(per_shard.begin(), per_shard.end());
+    return static_cast<double>(largest) * num_shards / ids.size();
+}
+
+int main(int argc, char* argv[]) {
+    std::string path = argc > 1 ? argv[1] : "test_data/input_packets.bin";
+    std::ifstream in(path, std::ios::binary);
+    std::vector<uint8_t> capture((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    std::vector<uint32_t> messages;   // subject_id of every message in the capture
+    size_t off = 0;
+    while (off + 4 <= capture.size()) {
+        uint32_t len_net;
+        std::memcpy(&len_net, capture.data() + off, 4);
+        size_t frame_len = 4 + ntohl(len_net);
+        if (off + frame_len > capture.size()) break;
+        for_each_message(capture.data() + off, frame_len, [&](const PacketView& view) {
+            messages.push_back(view.subject_id);
+        });
+        off += frame_len;
+    }
+    if (messages.empty()) {
+        std::cerr << "FAIL: no messages in " << path << "\n";
+        return 1;
+    }
+    const std::set<uint32_t> subjects(messages.begin(), messages.end());
+
+    struct IdSet {
+        const char* name;
+        std::vector<uint32_t> ids;
+    };
+    std::vector<IdSet> sets;
+    for (uint32_t stride : {1u, 64u, 4096u}) {
+        IdSet set{stride == 1 ? "dense 10000+" : stride == 64 ? "stride 64" : "stride 4096", {}};
+        for (uint32_t i = 0; i < 16384; ++i) set.ids.push_back(10000 + i * stride);
+        sets.push_back(std::move(set));
+    }
+
+    bool ok = true;
+    for (size_t n : SHARD_COUNTS) {
+        for (const IdSet& set : sets) {
+            const double share = worst_share(set.ids, n);
+            if (share > 1.05) {
+                std::cerr << "FAIL: " << set.name << " over " << n << " shards: largest shard holds " << share
+                          << "x a fair share\n";
+                ok = false;
+            }
+        }
+
+        std::vector<size_t> per_shard(n, 0);
+        for (uint32_t id : messages) ++per_shard[ShardedIngest::shardFor(id, n)];
+        std::set<size_t> used;
+        for (uint32_t id : subjects) used.insert(ShardedIngest::shardFor(id, n));
+        std::cout << n << " shards: capture messages per shard";
+        for (size_t count : per_shard) std::cout << " " << count;
+        std::cout << "\n";
+        const size_t possible = std::min(n, subjects.size());
+        if (used.size() + 1 < possible) {
+            std::cerr << "FAIL: capture's " << subjects.size() << " subjects use " << used.size() << " of " << n
+                      << " shards\n";
+            ok = false;
+        }
+    }
+    if (!ok) return 1;
+    std::cout << "PASS: shard spread\n";
+    return 0;
+}
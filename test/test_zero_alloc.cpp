@@ -0,0 +1,205 @@
+// test_zero_alloc.cpp
+// Counts heap allocations per packet over a capture, after one warm-up pass
+// has created every subject's book and record. Fails if any packet allocates
+// on:
+//   - the core path: parse_packet_view, book update and score calculation
+//   - the service's default path: process_decoded_packet, emit_scores and
+//     TcpSender::sendScores into a loopback socket, with the latency trace on
+//   - the service's staged path: a ScoreSet with analytics scored through a
+//     ScoreBatch, under a rate-limiting EmissionThrottle whose held scores
+//     are released after every packet
+// The owning parse_data_packet path is counted too, as a check that the
+// counter works.
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+#include "../include/parser_utils.hpp"
+#include "../include/data_book.hpp"
+#include "../include/composite_score_calculator.hpp"
+#include "../include/process_packet_core.hpp"
+#include "alloc_counter.hpp"
+
+struct Frame {
+    const uint8_t* data;
+    size_t length;
+};
+
+// Loopback TCP endpoint for one sender: accepts one connection and reads it
+// to EOF into a fixed buffer, so it never allocates while packets are counted
+class Sink {
+public:
+    Sink() {
+        fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(fd_, (sockaddr*)&addr, sizeof(addr));
+        listen(fd_, 1);
+        socklen_t len = sizeof(addr);
+        getsockname(fd_, (sockaddr*)&addr, &len);
+        port_ = ntohs(addr.sin_port);
+        thread_ = std::thread([this] {
+            int conn = accept(fd_, nullptr, nullptr);
+            static uint8_t buf[64 * 1024];
+            ssize_t n;
+            while ((n = recv(conn, buf, sizeof(buf), 0)) > 0) bytes_ += static_cast<size_t>(n);
+            close(conn);
+        });
+    }
+    ~Sink() { close(fd_); }
+
+    uint16_t port() const { return port_; }
+    // After the sender has closed
+    size_t join() {
+        thread_.join();
+        return bytes_;
+    }
+
+private:
+    int fd_ = -1;
+    uint16_t port_ = 0;
+    std::thread thread_;
+    size_t bytes_ = 0;
+};
+
+// Allocations over the second of two passes of serve() over the frames
+template <typename Serve>
+static size_t count_second_pass(const std::vector<Frame>& frames, Serve&& serve) {
+    for (const auto& f : frames) serve(f);
+    const size_t before = g_allocations;
+    for (const auto& f : frames) serve(f);
+    return g_allocations - before;
+}
+
+int main(int argc, char* argv[]) {
+    std::string path = argc > 1 ? argv[1] : "test_data/input_packets.bin";
+    std::ifstream in(path, std::ios::binary);
+    std::vector<uint8_t> capture((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    std::vector<Frame> frames;
+    size_t off = 0;
+    while (off + 4 <= capture.size()) {
+        uint32_t len_net;
+        std::memcpy(&len_net, capture.data() + off, 4);
+        size_t frame_len = 4 + ntohl(len_net);
+        if (off + frame_len > capture.size()) break;
+        frames.push_back(Frame{capture.data() + off, frame_len});
+        off += frame_len;
+    }
+    if (frames.empty()) {
+        std::cerr << "FAIL: no frames in " << path << "\n";
+        return 1;
+    }
+
+    DataBookManager books;
+    CompositeScoreCalculator calculator;
+    int64_t score_sum = 0;
+    size_t parse_failures = 0;
+
+    const size_t view_allocs = count_second_pass(frames, [&](const Frame& f) {
+        PacketView view;
+        if (!parse_packet_view(f.data, f.length, view)) {
+            ++parse_failures;
+            return;
+        }
+        DataBook& book = books.getOrCreateBook(view.subject_id);
+        book.applyUpdates(view.updates);
+        score_sum += calculator.calculateCompositeScore(book);
+    });
+
+    size_t before = g_allocations;
+    for (const auto& f : frames) {
+        ProcessedMessage msg;
+        if (parse_data_packet(f.data, f.length, msg)) score_sum += msg.updates.size();
+    }
+    size_t owning_allocs = g_allocations - before;
+
+    // The service's default path, as main runs it for one datagram at a time
+    std::vector<LatencySample> latency_log;
+    Sink direct_sink;
+    TcpSender direct_sender("127.0.0.1", direct_sink.port());
+    DataBookManager direct_books;
+    RegisteredScorer scorer;
+    size_t direct_allocs = 0;
+    if (direct_sender.connect()) {
+        direct_allocs = count_second_pass(frames, [&](const Frame& f) {
+            if (!for_each_message(f.data, f.length, [&](const PacketView& view) {
+                    process_decoded_packet(view, direct_books, scorer, &latency_log, nullptr, -1, &direct_sender);
+                })) {
+                ++parse_failures;
+            }
+        });
+    }
+    direct_sender.close();
+    const size_t direct_bytes = direct_sink.join();
+
+    // Staged scoring of a ScoreSet with analytics and throttling
+    ScoreSet score_set;
+    for (const char* name : {"top", "vwap10", "exp50", "imbalance"}) score_set.add(*find_scorer(name));
+    Sink staged_sink;
+    TcpSender staged_sender("127.0.0.1", staged_sink.port());
+    staged_sender.setRecordAnalytics(true);
+    DataBookManager staged_books;
+    ScoreBatch batch;
+    EmissionPolicy policy;
+    policy.min_interval_ns = 20000;   // some changes are held, and released a few packets later
+    EmissionThrottle throttle;
+    throttle.setDefault(policy);
+    size_t staged_allocs = 0;
+    if (staged_sender.connect()) {
+        staged_allocs = count_second_pass(frames, [&](const Frame& f) {
+            if (!for_each_message(f.data, f.length, [&](const PacketView& view) {
+                    stage_decoded_packet(view, staged_books, score_set, batch, &latency_log, nullptr,
+                                         &staged_sender, &throttle);
+                })) {
+                ++parse_failures;
+            }
+            flush_score_batch(batch, score_set, &latency_log, nullptr, &staged_sender, &throttle);
+            release_held_scores(throttle, now_ns(), &staged_sender);
+        });
+        release_held_scores(throttle, UINT64_MAX, &staged_sender);
+    }
+    staged_sender.close();
+    const size_t staged_bytes = staged_sink.join();
+
+    std::cout << frames.size() << " packets: view path " << view_allocs << " allocations, "
+              << "service direct path " << direct_allocs << " (" << direct_bytes << " bytes sent), "
+              << "service staged path " << staged_allocs << " (" << staged_bytes << " bytes sent, "
+              << throttle.stats().held << " held), owning parse " << owning_allocs << " allocations (checksum "
+              << score_sum << ")\n";
+
+    bool ok = true;
+    if (parse_failures > 0) {
+        std::cerr << "FAIL: " << parse_failures << " packets did not parse\n";
+        ok = false;
+    }
+    if (owning_allocs == 0) {
+        std::cerr << "FAIL: allocation counter saw nothing on the owning path\n";
+        ok = false;
+    }
+    if (direct_bytes == 0 || staged_bytes == 0 || throttle.stats().held == 0) {
+        std::cerr << "FAIL: the service paths sent nothing or held nothing; is loopback TCP available?\n";
+        ok = false;
+    }
+    if (view_allocs != 0) {
+        std::cerr << "FAIL: view path allocated " << view_allocs << " times\n";
+        ok = false;
+    }
+    if (direct_allocs != 0) {
+        std::cerr << "FAIL: service direct path allocated " << direct_allocs << " times\n";
+        ok = false;
+    }
+    if (staged_allocs != 0) {
+        std::cerr << "FAIL: service staged path allocated " << staged_allocs << " times\n";
+        ok = false;
+    }
+    if (!ok) return 1;
+    std::cout << "PASS: zero allocations per packet\n";
+    return 0;
+}
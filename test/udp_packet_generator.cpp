@@ -5,8 +5,15 @@
 #include <cstdint>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <algorithm>
 #include <arpa/inet.h>
-#include <endian.h> 
+#include <unistd.h>
+#include "../include/udp_receiver.hpp"
+#include "../include/wire_schema.hpp"
 
 // Format constants
 constexpr int NUM_PACKETS = 20;
@@ -20,30 +27,61 @@ struct Update {
     uint32_t volume;    // units
 };
 
-void write_packet(std::ofstream& out, uint32_t subject_id, const std::vector<Update>& updates) {
-    uint32_t message_length = 4 + 2 + updates.size() * 14;
-    uint16_t num_updates = updates.size();
-
-    uint32_t msg_len_net = htonl(message_length);
-    uint32_t sid_net = htonl(subject_id);
-    uint16_t updates_net = htons(num_updates);
+void write_packet(std::ostream& out, uint32_t subject_id, const std::vector<Update>& updates) {
+    std::vector<uint8_t> buf(wire::message_size(updates.size()));
+    wire::encode_message(buf.data(), subject_id, updates.data(), static_cast<uint16_t>(updates.size()));
+    out.write(reinterpret_cast<const char*>(buf.data()), buf.size());
+}
 
-    out.write(reinterpret_cast<const char*>(&msg_len_net), sizeof(msg_len_net));
-    out.write(reinterpret_cast<const char*>(&sid_net), sizeof(sid_net));
-    out.write(reinterpret_cast<const char*>(&updates_net), sizeof(updates_net));
+// Sends the generated messages to ip:port, up to pack messages per datagram
+// (messages are framed by msg_len, so the receiver splits them again)
+void send_packed(const std::vector<std::string>& messages, const std::string& ip, uint16_t port, int pack) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, ip.c_str(), &addr.sin_addr);
+
+    std::string datagram;
+    int in_datagram = 0;
+    int datagrams = 0;
+    auto flush = [&]() {
+        if (datagram.empty()) return;
+        sendto(sock, datagram.data(), datagram.size(), 0, (sockaddr*)&addr, sizeof(addr));
+        datagram.clear();
+        in_datagram = 0;
+        ++datagrams;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    };
+    for (const auto& m : messages) {
+        if (in_datagram >= pack || datagram.size() + m.size() > UdpReceiver::MAX_DATAGRAM_SIZE) flush();
+        datagram += m;
+        ++in_datagram;
+    }
+    flush();
+    close(sock);
 
-    for (const auto& u : updates) {
-        uint64_t value_net = htobe64(u.value);
-        uint32_t vol_net = htonl(u.volume);
+    std::cout << "[INFO] Sent " << messages.size() << " messages in " << datagrams
+              << " datagrams to " << ip << ":" << port << std::endl;
+}
 
-        out.write(reinterpret_cast<const char*>(&u.level), sizeof(u.level));
-        out.write(reinterpret_cast<const char*>(&u.side), sizeof(u.side));
-        out.write(reinterpret_cast<const char*>(&value_net), sizeof(value_net));
-        out.write(reinterpret_cast<const char*>(&vol_net), sizeof(vol_net));
+int main(int argc, char* argv[]) {
+    std::string send_ip;
+    uint16_t send_port = 0;
+    int pack = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string opt = argv[i];
+        if (opt == "--send" && i + 2 < argc) {
+            send_ip = argv[++i];
+            send_port = static_cast<uint16_t>(std::stoi(argv[++i]));
+        } else if (opt == "--pack" && i + 1 < argc) {
+            pack = std::max(1, std::stoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--send <ip> <port> [--pack N]]" << std::endl;
+            return 1;
+        }
     }
-}
 
-int main() {
     std::ofstream bin("test_vectors/input_packets.bin", std::ios::binary);
     std::ofstream txt("test_vectors/input_packets.csv");
 
@@ -66,6 +104,7 @@ int main() {
         subject_pool.push_back(subject_dist(rng));
 
     txt << "packet_id,subject_id,update_id,level,side,value,volume\n";
+    std::vector<std::string> messages;
 
     for (int i = 0; i < NUM_PACKETS; ++i) {
         uint32_t sid = subject_pool[rng() % subject_pool.size()];
@@ -86,7 +125,10 @@ int main() {
                 << u.value << "," << u.volume << "\n";
         }
 
-        write_packet(bin, sid, updates);
+        std::ostringstream msg(std::ios::binary);
+        write_packet(msg, sid, updates);
+        messages.push_back(msg.str());
+        bin << messages.back();
     }
 
     // Force one packet with both demand and supply at level 0 for subject_pool[0]
@@ -94,11 +136,16 @@ int main() {
         {0, 0, 150000000, 100},  // demand
         {0, 1, 151000000, 200}   // supply
     };
-    write_packet(bin, subject_pool[0], guaranteed);
+    std::ostringstream msg(std::ios::binary);
+    write_packet(msg, subject_pool[0], guaranteed);
+    messages.push_back(msg.str());
+    bin << messages.back();
     txt << NUM_PACKETS << "," << subject_pool[0] << ",0,0,0,150000000,100\n";
     txt << NUM_PACKETS << "," << subject_pool[0] << ",1,0,1,151000000,200\n";
 
     std::cout << "[INFO] Generated " << NUM_PACKETS + 1
               << " packets to test_vectors/input_packets.bin" << std::endl;
+
+    if (!send_ip.empty()) send_packed(messages, send_ip, send_port, pack);
     return 0;
 }
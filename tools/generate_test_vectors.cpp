@@ -7,38 +7,17 @@
 #include <cstring>
 #include <unordered_map>
 #include <unordered_set>
-#include <arpa/inet.h>
-#include <endian.h>
 
 #include "../include/types.hpp"
 #include "../include/data_book.hpp"
 #include "../include/composite_score_calculator.hpp"
 #include "../include/parser_utils.hpp"
-
-static_assert(__BYTE_ORDER == __LITTLE_ENDIAN, "Expected little-endian platform");
+#include "../include/wire_schema.hpp"
 
 void write_packet(std::ostream& out, uint32_t subject_id, const std::vector<DataLevel>& levels) {
-    uint16_t count = levels.size();
-    uint32_t message_length = 4 + 2 + count * (1 + 1 + 8 + 4);
-
-    uint32_t message_length_be = htonl(message_length);
-    uint32_t subj_id_be = htonl(subject_id);
-    uint16_t count_be = htons(count);
-
-    out.write(reinterpret_cast<const char*>(&message_length_be), sizeof(message_length_be));
-    out.write(reinterpret_cast<const char*>(&subj_id_be), sizeof(subj_id_be));
-    out.write(reinterpret_cast<const char*>(&count_be), sizeof(count_be));
-
-    for (const auto& lvl : levels) {
-        uint8_t level_be = lvl.level;
-        uint8_t side_be = lvl.side;
-        out.write(reinterpret_cast<const char*>(&level_be), sizeof(level_be));
-        out.write(reinterpret_cast<const char*>(&side_be), sizeof(side_be));
-        uint64_t value_be = htobe64(static_cast<uint64_t>(lvl.value));
-        out.write(reinterpret_cast<const char*>(&value_be), sizeof(value_be));
-        uint32_t vol_be = htonl(lvl.volume);
-        out.write(reinterpret_cast<const char*>(&vol_be), sizeof(vol_be));
-    }
+    std::vector<uint8_t> buf(wire::message_size(levels.size()));
+    wire::encode_message(buf.data(), subject_id, levels.data(), static_cast<uint16_t>(levels.size()));
+    out.write(reinterpret_cast<const char*>(buf.data()), buf.size());
 }
 
 int main(int argc, char* argv[]) {
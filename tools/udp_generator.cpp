@@ -1,61 +1,40 @@
 // tools/udp_generator.cpp
 #include <iostream>
 #include <vector>
-#        double demand = value_dist(rng);
-        double supply = demand + 0.5;
-        uint32_t qty = qty_dist(rng);
-        auto packet = createPacket(sid, demand, supply, qty);ude <cstring>
+#include <cstring>
+#include <algorithm>
 #include <random>
 #include <thread>
 #include <chrono>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include "../include/types.hpp"
+#include "../include/wire_schema.hpp"
 
-std::vector<uint8_t> createPacket(uint32_t sid, double demand, double supply, uint32_t qty) {
-    std::vector<uint8_t> data;
-
-    uint32_t msg_len = 4 + 2 + 2 * (1 + 1 + 8 + 4);
-    uint16_t num_updates = 2;
-
-    int64_t demand_value = static_cast<int64_t>(demand * 1e9);
-    int64_t supply_value = static_cast<int64_t>(supply * 1e9);
+// Receiver-side datagram limit (UdpReceiver::MAX_DATAGRAM_SIZE)
+constexpr size_t MAX_DATAGRAM_SIZE = 2048;
 
-    auto append = [&](const void* p, size_t len) {
-        const uint8_t* b = reinterpret_cast<const uint8_t*>(p);
-        data.insert(data.end(), b, b + len);
+std::vector<uint8_t> createPacket(uint32_t sid, double demand, double supply, uint32_t qty) {
+    const DataLevel levels[2] = {
+        {0, 0, static_cast<int64_t>(demand * 1e9), qty},
+        {0, 1, static_cast<int64_t>(supply * 1e9), qty},
     };
-
-    uint32_t msg_len_net = htonl(msg_len);
-    uint32_t sid_net = htonl(sid);
-    uint16_t num_net = htons(num_updates);
-    append(&msg_len_net, 4);
-    append(&sid_net, 4);
-    append(&num_net, 2);
-
-    uint8_t level = 0, side_demand = 0, side_supply = 1;
-    uint64_t demand_be, supply_be;
-    std::memcpy(&demand_be, &demand_value, 8);
-    std::memcpy(&supply_be, &supply_value, 8);
-    demand_be = htobe64(demand_be);
-    supply_be = htobe64(supply_be);
-
-    uint32_t qty_net = htonl(qty);
-
-    append(&level, 1); append(&side_demand, 1); append(&demand_be, 8); append(&qty_net, 4);
-    append(&level, 1); append(&side_supply, 1); append(&supply_be, 8); append(&qty_net, 4);
-
+    std::vector<uint8_t> data(wire::message_size(2));
+    wire::encode_message(data.data(), sid, levels, 2);
     return data;
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 4) {
-        std::cerr << "Usage: " << argv[0] << " <mcast_ip> <port> <num_packets>\n";
+    if (argc != 4 && argc != 5) {
+        std::cerr << "Usage: " << argv[0] << " <mcast_ip> <port> <num_packets> [messages_per_datagram]\n";
         return 1;
     }
 
     std::string ip = argv[1];
     uint16_t port = std::stoi(argv[2]);
     int count = std::stoi(argv[3]);
+    // Messages are framed by msg_len, so several can share one datagram
+    int pack = argc == 5 ? std::max(1, std::stoi(argv[4])) : 1;
 
     sockaddr_in addr = {};
     addr.sin_family = AF_INET;
@@ -68,15 +47,27 @@ int main(int argc, char* argv[]) {
     std::uniform_real_distribution<double> value_dist(95.0, 105.0);
     std::uniform_int_distribution<int> qty_dist(100, 1000);
 
+    std::vector<uint8_t> datagram;
+    int in_datagram = 0;
+    auto flush = [&]() {
+        if (datagram.empty()) return;
+        sendto(sock, datagram.data(), datagram.size(), 0, (sockaddr*)&addr, sizeof(addr));
+        datagram.clear();
+        in_datagram = 0;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    };
+
     for (int i = 0; i < count; ++i) {
         uint32_t sid = sid_dist(rng);
         double demand = value_dist(rng);
         double supply = demand + 0.5;
         int qty = qty_dist(rng);
         auto packet = createPacket(sid, demand, supply, qty);
-        sendto(sock, packet.data(), packet.size(), 0, (sockaddr*)&addr, sizeof(addr));
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (in_datagram >= pack || datagram.size() + packet.size() > MAX_DATAGRAM_SIZE) flush();
+        datagram.insert(datagram.end(), packet.begin(), packet.end());
+        ++in_datagram;
     }
+    flush();
 
     close(sock);
     return 0;